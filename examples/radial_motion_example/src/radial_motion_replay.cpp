@@ -0,0 +1,34 @@
+#include <radial_motion.h>
+#include <states/navigate_to_end_point.h>
+#include <states/navigate_to_radial_start.h>
+#include <states/return_to_radial_start.h>
+#include <states/rotate_degrees.h>
+
+//------------------------------------------------------------------------------
+
+// usage: radial_motion_example_replay <event log> [speed]
+// the event log is recorded by radial_motion_example_node with the ~smacc_event_log_file parameter.
+// speed 0 (default) replays the events as fast as possible
+int main(int argc, char **argv) 
+{
+  ros::init(argc, argv, "radial_motion_replay", ros::init_options::NoRosout | ros::init_options::AnonymousName);
+
+  if(argc < 2)
+  {
+    std::cerr << "usage: " << argv[0] << " <event log> [speed]" << std::endl;
+    return 1;
+  }
+
+  smacc::ReplayOptions options;
+  if(argc > 2)
+  {
+    options.speed = atof(argv[2]);
+  }
+
+  smacc::ReplayStats stats = smacc::replay<RadialMotionStateMachine>(argv[1], options);
+
+  std::stringstream ss;
+  stats.toString(ss);
+  std::cout << ss.str() << std::endl;
+  return stats.replayed > 0 ? 0 : 1;
+}
@@ -67,7 +67,8 @@ public:
       // we only will react when the result is succeeded
       if (ev.getResult() == actionlib::SimpleClientGoalState::SUCCEEDED)
       {
-        // ev.resultMessage provides access to the move_base action server result structure
+        // ev.resultMessage is a shared pointer to the move_base action server result structure
+        // (ev.getResultMessage() returns it by reference)
 
         ROS_INFO("Received event to movebase: %s",ev.getResult().toString().c_str());
         return transit<ExecuteToolState>();
@@ -0,0 +1,137 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/smacc_action_client_base.h>
+#include <actionlib/action_definition.h>
+#include <actionlib/client/simple_client_goal_state.h>
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace smacc_mission_benchmark
+{
+using smacc::ISmaccActionClient;
+
+// Queue of the answers of the fake action servers. The answers are not delivered from sendGoal
+// (that is, from the state machine thread while a state is being constructed) but when run() is called
+class FakeActionServers
+{
+public:
+    static FakeActionServers& instance();
+
+    void post(const boost::function<void()>& answer);
+
+    // delivers the pending answers, including the ones posted meanwhile. Returns the number of answers
+    std::size_t run();
+
+    std::size_t pending() const;
+
+    // discards the pending answers
+    void clear();
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<boost::function<void()>> answers_;
+};
+
+// In-process stand-in of the action server of ActionType (offline mode). When it has a handler, it is the
+// offline goal handler of the SmaccActionClientBase<ActionType> clients, so their goals are answered by it
+// instead of being dropped:
+//
+//     FakeActionServer<move_base_msgs::MoveBaseAction>::setHandler(
+//         [](ISmaccActionClient& client, const move_base_msgs::MoveBaseGoal& goal,
+//            move_base_msgs::MoveBaseResult& result, std::vector<move_base_msgs::MoveBaseFeedback>& feedback) {
+//             return actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::SUCCEEDED);
+//         });
+//
+// The feedback messages are delivered first and then the result. If the handler returns an ACTIVE or
+// PENDING state the goal is never finished (as a server that keeps working until it is preempted).
+// The client gives access to the state machine and its components (i.e. to simulate the odometry), and
+// the handler can post its own answers: they are delivered before the answer of the goal.
+template <typename ActionType>
+class FakeActionServer
+{
+public:
+    ACTION_DEFINITION(ActionType);
+
+    typedef boost::function<actionlib::SimpleClientGoalState(ISmaccActionClient&, const Goal&, Result&,
+                                                             std::vector<Feedback>&)>
+        Handler;
+
+    static void setHandler(const Handler& handler)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            handler_() = handler;
+        }
+
+        typedef smacc::SmaccActionClientBase<ActionType> Client;
+        if(handler)
+            Client::setOfflineGoalHandler(&FakeActionServer<ActionType>::sendGoal);
+        else
+            Client::setOfflineGoalHandler(typename Client::OfflineGoalHandler());
+    }
+
+    static void reset()
+    {
+        setHandler(Handler());
+    }
+
+    static bool isEnabled()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        return !handler_().empty();
+    }
+
+    // offline goal handler of the action clients. The answer is delivered to the client as actionlib would do
+    static void sendGoal(smacc::SmaccActionClientBase<ActionType>& client, const Goal& goal)
+    {
+        Handler handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            handler = handler_();
+        }
+
+        auto result = boost::make_shared<Result>();
+        auto feedback = boost::make_shared<std::vector<Feedback>>();
+        if (!handler)
+            return;
+
+        actionlib::SimpleClientGoalState state = handler(client, goal, *result, *feedback);
+
+        auto* clientPtr = &client;
+        FakeActionServers::instance().post([clientPtr, state, result, feedback]() {
+            for (auto& message : *feedback)
+            {
+                clientPtr->deliverOfflineFeedback(boost::make_shared<const Feedback>(message));
+            }
+
+            if (state.isDone())
+            {
+                clientPtr->deliverOfflineResult(state, result);
+            }
+        });
+    }
+
+private:
+    static std::mutex& mutex()
+    {
+        static std::mutex instance;
+        return instance;
+    }
+
+    static Handler& handler_()
+    {
+        static Handler instance;
+        return instance;
+    }
+};
+}
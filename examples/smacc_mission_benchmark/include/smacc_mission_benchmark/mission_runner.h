@@ -0,0 +1,121 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/common.h>
+#include <smacc_mission_benchmark/fake_action_server.h>
+#include <smacc/latency_histogram.h>
+#include <smacc/signal_detector.h>
+#include <ros/master.h>
+
+#include <sstream>
+#include <string>
+
+namespace smacc_mission_benchmark
+{
+// accumulated statistics of the missions of a benchmark
+struct MissionStats
+{
+    MissionStats();
+
+    uint64_t missions;
+
+    // missions where the state machine terminated (the others stalled waiting for some answer)
+    uint64_t completedMissions;
+
+    // dispatched events and events that changed the active states
+    uint64_t events;
+    uint64_t transitions;
+
+    double wallSeconds;
+    double cpuSeconds;
+
+    // SmaccAllocator counters
+    uint64_t poolAllocations;
+    uint64_t systemAllocations;
+
+    // all the heap allocations, if the benchmark counts them (see SmaccAllocationStats::setHeapAllocationCounter)
+    uint64_t heapAllocations;
+
+    // from the creation of the events to the end of the transitions they trigger
+    smacc::LatencyHistogram reactionLatency;
+
+    void toString(std::stringstream& ss) const;
+};
+
+namespace mission_benchmark
+{
+// counters at the beginning of a mission
+struct Sample
+{
+    double wall;
+    double cpu;
+    uint64_t poolAllocations;
+    uint64_t systemAllocations;
+    uint64_t heapAllocations;
+};
+
+Sample sample();
+
+// adds the counters of the mission (from start to now) to the stats
+void accumulate(const Sample& start, MissionStats& stats);
+
+// reads the statistics of the state machine before it is destroyed
+void collect(smacc::ISmaccStateMachine* stateMachine, MissionStats& stats);
+}
+
+// Runs one mission of the state machine in offline mode (no roscore) in the current thread.
+// The goals of the action clients are answered by the FakeActionServer handlers, so they have to be set
+// before. The mission ends when there is no pending answer after the last event (the state machine
+// terminated or it waits for a goal that never finishes).
+//
+// usage:
+//     ros::init(argc, argv, "mission_benchmark", ros::init_options::NoRosout);
+//     FakeActionServer<move_base_msgs::MoveBaseAction>::setHandler(...);
+//     smacc_mission_benchmark::MissionStats stats;
+//     for (int i = 0; i < 100; i++)
+//         smacc_mission_benchmark::runMission<RadialMotionStateMachine>(stats);
+template <typename StateMachineType>
+void runMission(MissionStats& stats)
+{
+    smacc::setOfflineMode(true);
+
+    // the master calls that roscpp does by itself (ros::start) fail at once when there is no roscore
+    ros::master::setRetryTimeout(ros::WallDuration(0.01));
+
+    FakeActionServers& servers = FakeActionServers::instance();
+    servers.clear();
+
+    mission_benchmark::Sample start = mission_benchmark::sample();
+    {
+        // non blocking scheduler: it is executed in this thread until its queue is empty
+        SmaccScheduler scheduler(false);
+        smacc::SignalDetector signalDetector;
+
+        SmaccScheduler::processor_handle handle = scheduler.create_processor<StateMachineType>(&signalDetector);
+        scheduler.initiate_processor(handle);
+        scheduler(0);
+
+        while (servers.run() > 0)
+        {
+            scheduler(0);
+        }
+
+        for (auto* stateMachine : signalDetector.getStateMachines())
+        {
+            mission_benchmark::collect(stateMachine, stats);
+        }
+
+        // the goals that never finish are dropped before their clients are destroyed
+        servers.clear();
+
+        scheduler.destroy_processor(handle);
+        scheduler(0);
+    }
+
+    mission_benchmark::accumulate(start, stats);
+}
+}
@@ -0,0 +1,13 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc_mission_benchmark/mission_runner.h>
+
+// one offline mission of each example state machine (see smacc_mission_benchmark::runMission)
+void runRadialMotionMission(smacc_mission_benchmark::MissionStats& stats);
+
+void runWayPointsMission(smacc_mission_benchmark::MissionStats& stats);
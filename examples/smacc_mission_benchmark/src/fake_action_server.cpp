@@ -0,0 +1,59 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc_mission_benchmark/fake_action_server.h>
+
+namespace smacc_mission_benchmark
+{
+FakeActionServers& FakeActionServers::instance()
+{
+    static FakeActionServers servers;
+    return servers;
+}
+
+void FakeActionServers::post(const boost::function<void()>& answer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    answers_.push_back(answer);
+}
+
+/**
+******************************************************************************************************************
+* run()
+******************************************************************************************************************
+*/
+std::size_t FakeActionServers::run()
+{
+    std::size_t count = 0;
+    for (;;)
+    {
+        boost::function<void()> answer;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (answers_.empty())
+                return count;
+
+            answer.swap(answers_.front());
+            answers_.pop_front();
+        }
+
+        // the answer may send new goals (and post new answers)
+        answer();
+        count++;
+    }
+}
+
+std::size_t FakeActionServers::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return answers_.size();
+}
+
+void FakeActionServers::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    answers_.clear();
+}
+}
@@ -0,0 +1,163 @@
+#include <smacc_mission_benchmark/missions.h>
+#include <smacc_navigation_plugin/move_base_to_goal.h>
+#include <smacc_odom_tracker/odom_tracker.h>
+#include <smacc_tool_plugin_template/smacc_tool_plugin.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// usage: smacc_mission_benchmark [missions] [--verbose]
+// runs the given number of missions (default 100) of the radial motion and the waypoints motion state
+// machines without roscore. move_base, the tool action server and the odometry are simulated in-process:
+//  - move_base moves the robot to the goal in a few odometry steps and succeeds
+//  - the tool server keeps running (feedback STATE_RUNNING) until it is preempted
+
+//------------------------------------------------------------------------------
+// heap allocation counter
+
+namespace
+{
+std::atomic<uint64_t> heapAllocations(0);
+
+uint64_t countHeapAllocations()
+{
+  return heapAllocations.load(std::memory_order_relaxed);
+}
+}
+
+void* operator new(std::size_t size)
+{
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size != 0 ? size : 1))
+    return ptr;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+//------------------------------------------------------------------------------
+// in-process stand-ins
+
+namespace
+{
+// odometry steps from the current pose to the goal of move_base
+const int ODOMETRY_STEPS = 10;
+
+// the robot pose is shared by all the missions of a state machine (they start at the origin)
+geometry_msgs::Pose robotPose;
+
+void resetRobotPose()
+{
+  robotPose = geometry_msgs::Pose();
+  robotPose.orientation.w = 1;
+}
+
+actionlib::SimpleClientGoalState moveBase(smacc::ISmaccActionClient& client, const move_base_msgs::MoveBaseGoal& goal,
+                                          move_base_msgs::MoveBaseResult& result,
+                                          std::vector<move_base_msgs::MoveBaseFeedback>& feedback)
+{
+  // the odom tracker of the state machine receives the odometry of the motion before the result
+  smacc_odom_tracker::OdomTracker* odomTracker;
+  client.getStateMachine()->requiresComponent(odomTracker);
+
+  geometry_msgs::Pose start = robotPose;
+  const geometry_msgs::Pose& target = goal.target_pose.pose;
+
+  auto odometry = boost::make_shared<std::vector<nav_msgs::Odometry>>(ODOMETRY_STEPS);
+  for (int i = 0; i < ODOMETRY_STEPS; i++)
+  {
+    double k = (i + 1) / (double)ODOMETRY_STEPS;
+    nav_msgs::Odometry& odom = (*odometry)[i];
+    odom.header.frame_id = "odom";
+    odom.pose.pose.position.x = start.position.x + k * (target.position.x - start.position.x);
+    odom.pose.pose.position.y = start.position.y + k * (target.position.y - start.position.y);
+    odom.pose.pose.orientation = target.orientation;
+
+    move_base_msgs::MoveBaseFeedback step;
+    step.base_position.header = goal.target_pose.header;
+    step.base_position.pose = odom.pose.pose;
+    feedback.push_back(step);
+  }
+
+  robotPose = odometry->back().pose.pose;
+
+  smacc_mission_benchmark::FakeActionServers::instance().post([odomTracker, odometry]() {
+    for (auto& odom : *odometry)
+    {
+      odomTracker->processOdometryMessage(odom);
+    }
+  });
+
+  return actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::SUCCEEDED);
+}
+
+actionlib::SimpleClientGoalState toolServer(smacc::ISmaccActionClient& client,
+                                            const smacc_tool_plugin_template::ToolControlGoal& goal,
+                                            smacc_tool_plugin_template::ToolControlResult& result,
+                                            std::vector<smacc_tool_plugin_template::ToolControlFeedback>& feedback)
+{
+  smacc_tool_plugin_template::ToolControlFeedback state;
+  state.state = goal.command == smacc_tool_plugin_template::ToolControlGoal::CMD_START
+                    ? smacc_tool_plugin_template::ToolControlFeedback::STATE_RUNNING
+                    : smacc_tool_plugin_template::ToolControlFeedback::STATE_IDLE;
+  feedback.push_back(state);
+
+  return actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::ACTIVE);
+}
+
+void runBenchmark(const std::string& name, void (*runMission)(smacc_mission_benchmark::MissionStats&), int missions)
+{
+  smacc_mission_benchmark::MissionStats stats;
+  for (int i = 0; i < missions; i++)
+  {
+    resetRobotPose();
+    runMission(stats);
+  }
+
+  std::stringstream ss;
+  stats.toString(ss);
+  std::cout << "---- " << name << " ----" << std::endl << ss.str() << std::endl;
+}
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "smacc_mission_benchmark", ros::init_options::NoRosout | ros::init_options::AnonymousName);
+
+  int missions = 100;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::string(argv[i]) == "--verbose")
+      verbose = true;
+    else
+      missions = atoi(argv[i]);
+  }
+
+  // the logs of the states would be the most of the cost of the missions
+  if (!verbose && ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Error))
+  {
+    ros::console::notifyLoggerLevelsChanged();
+  }
+
+  smacc::SmaccAllocationStats::setHeapAllocationCounter(&countHeapAllocations);
+  smacc_mission_benchmark::FakeActionServer<move_base_msgs::MoveBaseAction>::setHandler(&moveBase);
+  smacc_mission_benchmark::FakeActionServer<smacc_tool_plugin_template::ToolControlAction>::setHandler(&toolServer);
+
+  runBenchmark("RadialMotionStateMachine", &runRadialMotionMission, missions);
+  runBenchmark("WayPointsStateMachine", &runWayPointsMission, missions);
+  return 0;
+}
@@ -0,0 +1,92 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc_mission_benchmark/mission_runner.h>
+#include <smacc/smacc_state_machine.h>
+
+#include <time.h>
+
+namespace smacc_mission_benchmark
+{
+MissionStats::MissionStats()
+    : missions(0), completedMissions(0), events(0), transitions(0), wallSeconds(0), cpuSeconds(0),
+      poolAllocations(0), systemAllocations(0), heapAllocations(0)
+{
+}
+
+/**
+******************************************************************************************************************
+* toString()
+******************************************************************************************************************
+*/
+void MissionStats::toString(std::stringstream& ss) const
+{
+    double perMission = missions > 0 ? 1.0 / missions : 0;
+
+    ss << "missions: " << missions << " (" << completedMissions << " completed)" << std::endl;
+    ss << " transitions/s: " << (wallSeconds > 0 ? transitions / wallSeconds : 0)
+       << ", events/s: " << (wallSeconds > 0 ? events / wallSeconds : 0) << std::endl;
+    ss << " per mission: " << transitions * perMission << " transitions, " << events * perMission << " events, "
+       << wallSeconds * perMission * 1e3 << " ms wall, " << cpuSeconds * perMission * 1e3 << " ms cpu" << std::endl;
+    ss << " allocations per mission: " << heapAllocations * perMission << " heap, " << poolAllocations * perMission
+       << " smacc pool, " << systemAllocations * perMission << " pool growth" << std::endl;
+    ss << " event to transition latency (us): p50 " << reactionLatency.percentile(0.5) / 1000.0 << ", p99 "
+       << reactionLatency.percentile(0.99) / 1000.0 << ", max " << reactionLatency.max() / 1000.0;
+}
+
+namespace mission_benchmark
+{
+namespace
+{
+double clockSeconds(clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+}
+
+Sample sample()
+{
+    auto& allocationStats = smacc::SmaccAllocationStats::instance();
+
+    Sample ret;
+    ret.wall = clockSeconds(CLOCK_MONOTONIC);
+    ret.cpu = clockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    ret.poolAllocations = allocationStats.poolAllocations.load(std::memory_order_relaxed);
+    ret.systemAllocations = allocationStats.systemAllocations.load(std::memory_order_relaxed);
+    ret.heapAllocations = allocationStats.heapAllocations();
+    return ret;
+}
+
+void accumulate(const Sample& start, MissionStats& stats)
+{
+    Sample end = sample();
+    stats.missions++;
+    stats.wallSeconds += end.wall - start.wall;
+    stats.cpuSeconds += end.cpu - start.cpu;
+    stats.poolAllocations += end.poolAllocations - start.poolAllocations;
+    stats.systemAllocations += end.systemAllocations - start.systemAllocations;
+    stats.heapAllocations += end.heapAllocations - start.heapAllocations;
+}
+
+void collect(smacc::ISmaccStateMachine* stateMachine, MissionStats& stats)
+{
+    stats.events += stateMachine->getEventLatencyHistogram().count();
+    stats.transitions += stateMachine->getTransitionCount();
+    stats.reactionLatency.add(stateMachine->getReactionLatencyHistogram());
+
+    // a terminated state machine has no active state
+    std::vector<uint64_t> active;
+    stateMachine->getActiveStates().snapshot(active);
+    bool terminated = true;
+    for (uint64_t word : active)
+        terminated = terminated && word == 0;
+
+    if (terminated)
+        stats.completedMissions++;
+}
+}
+}
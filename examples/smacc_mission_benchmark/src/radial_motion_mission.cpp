@@ -0,0 +1,14 @@
+#include <radial_motion.h>
+#include <states/navigate_to_end_point.h>
+#include <states/navigate_to_radial_start.h>
+#include <states/return_to_radial_start.h>
+#include <states/rotate_degrees.h>
+
+#include <smacc_mission_benchmark/missions.h>
+
+//------------------------------------------------------------------------------
+
+void runRadialMotionMission(smacc_mission_benchmark::MissionStats& stats)
+{
+  smacc_mission_benchmark::runMission<RadialMotionStateMachine>(stats);
+}
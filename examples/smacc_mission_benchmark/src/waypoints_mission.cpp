@@ -0,0 +1,41 @@
+#include <waypoints_machine.h>
+#include <states/go_to_odd_waypoint.h>
+#include <states/go_to_even_waypoint.h>
+
+#include <smacc_mission_benchmark/missions.h>
+
+#include <ros/package.h>
+#include <yaml-cpp/yaml.h>
+
+//------------------------------------------------------------------------------
+
+// there is no parameter server in offline mode: the waypoints are loaded from the config file of the
+// waypoints_motion package, the same one that its launch file loads
+void loadWayPointsConfig()
+{
+  std::string path = ros::package::getPath("waypoints_motion") + "/config/waypoints_motion_sm_config.yaml";
+  YAML::Node waypoints = YAML::LoadFile(path)["WayPointsStateMachine"]["waypoints"];
+  if (!waypoints.IsSequence())
+    throw std::runtime_error("WayPointsStateMachine/waypoints not found in " + path);
+
+  XmlRpc::XmlRpcValue& waypointsList = WayPointsStateMachine::offlineWaypoints();
+  waypointsList.setSize(waypoints.size());
+  for (size_t i = 0; i < waypoints.size(); i++)
+  {
+    waypointsList[i].setSize(2);
+    waypointsList[i][0] = waypoints[i][0].as<double>();
+    waypointsList[i][1] = waypoints[i][1].as<double>();
+  }
+}
+
+void runWayPointsMission(smacc_mission_benchmark::MissionStats& stats)
+{
+  static bool configLoaded = false;
+  if (!configLoaded)
+  {
+    loadWayPointsConfig();
+    configLoaded = true;
+  }
+
+  smacc_mission_benchmark::runMission<WayPointsStateMachine>(stats);
+}
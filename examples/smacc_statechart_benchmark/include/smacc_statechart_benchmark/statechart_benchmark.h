@@ -0,0 +1,142 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc_statechart_benchmark/synthetic_statechart.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace synthetic
+{
+// heap counters of the benchmark executable (it replaces the global operator new)
+uint64_t heapAllocations();
+
+// bytes currently allocated in the heap
+int64_t heapBytes();
+
+// peak resident memory of the process (bytes)
+int64_t peakResidentMemory();
+
+struct BenchmarkResult
+{
+    std::string shape;
+    std::string policy;
+    int states;
+
+    // creation and initiation of the first machine (it includes the static state table of SMACC)
+    double coldStartupSeconds;
+
+    // mean of the next machines
+    double startupSeconds;
+
+    // heap held by one machine after its initiation
+    uint64_t startupAllocations;
+    int64_t startupBytes;
+
+    uint64_t transitions;
+    double transitionsPerSecond;
+    double allocationsPerTransition;
+
+    void toString(std::stringstream& ss) const
+    {
+        ss << shape << " (" << states << " states), " << policy << ":" << std::endl;
+        ss << " startup: " << coldStartupSeconds * 1e3 << " ms first machine, " << startupSeconds * 1e3
+           << " ms next ones" << std::endl;
+        ss << " memory: " << startupBytes << " bytes (" << startupAllocations << " allocations) per machine" << std::endl;
+        ss << " transitions/s: " << transitionsPerSecond << " (" << transitions << " transitions, "
+           << allocationsPerTransition << " allocations per transition)";
+    }
+};
+
+namespace detail
+{
+inline double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+// Measures the startup (startups machines are created, initiated and destroyed), the heap of one machine
+// and the throughput of the given number of events of the shape workload. It is run in offline mode in the
+// current thread (non blocking scheduler)
+template <class Shape, class Policy>
+BenchmarkResult runStatechartBenchmark(uint64_t transitions, int startups)
+{
+    typedef typename Shape::template machine<Policy> Machine;
+
+    BenchmarkResult result;
+    result.shape = Shape::name();
+    result.policy = Policy::name();
+    result.states = Shape::states;
+
+    SmaccScheduler scheduler(false);
+
+    // startup
+    result.coldStartupSeconds = 0;
+    result.startupSeconds = 0;
+    for (int i = 0; i <= startups; i++)
+    {
+        smacc::SignalDetector signalDetector;
+
+        double start = detail::now();
+        auto handle = Policy::template create<Machine>(scheduler, signalDetector);
+        scheduler.initiate_processor(handle);
+        scheduler(0);
+        double elapsed = detail::now() - start;
+
+        if (i == 0)
+            result.coldStartupSeconds = elapsed;
+        else
+            result.startupSeconds += elapsed / startups;
+
+        scheduler.destroy_processor(handle);
+        scheduler(0);
+    }
+
+    // memory and throughput
+    smacc::SignalDetector signalDetector;
+
+    uint64_t allocations = heapAllocations();
+    int64_t bytes = heapBytes();
+
+    auto handle = Policy::template create<Machine>(scheduler, signalDetector);
+    scheduler.initiate_processor(handle);
+    scheduler(0);
+
+    result.startupAllocations = heapAllocations() - allocations;
+    result.startupBytes = heapBytes() - bytes;
+
+    std::vector<EventPtr> events = Shape::events();
+
+    // the events are queued in batches, as the scheduler of a busy state machine
+    const uint64_t BATCH = 1024;
+
+    allocations = heapAllocations();
+    double start = detail::now();
+    uint64_t sent = 0;
+    while (sent < transitions)
+    {
+        for (uint64_t i = 0; i < BATCH && sent < transitions; i++, sent++)
+        {
+            scheduler.queue_event(handle, events[sent % events.size()]);
+        }
+
+        scheduler(0);
+    }
+    double elapsed = detail::now() - start;
+
+    result.transitions = sent;
+    result.transitionsPerSecond = elapsed > 0 ? sent / elapsed : 0;
+    result.allocationsPerTransition = sent > 0 ? (heapAllocations() - allocations) / (double)sent : 0;
+
+    scheduler.destroy_processor(handle);
+    scheduler(0);
+
+    return result;
+}
+}
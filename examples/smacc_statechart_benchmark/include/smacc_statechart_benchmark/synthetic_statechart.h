@@ -0,0 +1,357 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/smacc.h>
+#include <boost/mpl/list.hpp>
+#include <boost/statechart/event.hpp>
+#include <boost/statechart/transition.hpp>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Generator of synthetic state machines to measure the cost of SmaccState against plain sc::simple_state.
+// Each shape is a template over the state policy, so the same machine is generated with:
+//  - SmaccStates: SmaccState states hosted by a SmaccStateMachineBase
+//  - PlainStates: sc::simple_state states hosted by a bare asynchronous_state_machine
+// Both run in the SmaccScheduler, so the difference is the overhead of SMACC (node handles, state table,
+// active state set, timings...).
+//
+// Shapes (the total number of states is the template parameter or the product of them):
+//  - Wide<N>: ring of N sibling states. EvNext goes to the next state
+//  - Deep<D>: chain of D nested states. EvNext exits and enters again the D levels
+//  - Orthogonal<K, M>: K orthogonal regions with a ring of M states each. EvNextIn<r> moves the region r
+//  - Bits<B>: the BitMachine of the Boost.Statechart examples (2^B states, B transitions per state).
+//    EvFlipBit<b> goes to the state with the bit b toggled. The workload visits all the states (gray code)
+namespace synthetic
+{
+typedef boost::intrusive_ptr<const sc::event_base> EventPtr;
+
+struct SmaccStates
+{
+    template <class MostDerived, class Context, class InnerInitial = mpl::list<>>
+    using state = smacc::SmaccState<MostDerived, Context, InnerInitial>;
+
+    template <class Derived, class InitialState>
+    struct machine : smacc::SmaccStateMachineBase<Derived, InitialState>
+    {
+        machine(my_context ctx, smacc::SignalDetector* signalDetector)
+            : smacc::SmaccStateMachineBase<Derived, InitialState>(ctx, signalDetector)
+        {
+        }
+    };
+
+    static const char* name()
+    {
+        return "SmaccState";
+    }
+
+    template <class Machine>
+    static SmaccScheduler::processor_handle create(SmaccScheduler& scheduler, smacc::SignalDetector& signalDetector)
+    {
+        return scheduler.create_processor<Machine>(&signalDetector);
+    }
+};
+
+struct PlainStates
+{
+    template <class MostDerived, class Context, class InnerInitial = mpl::list<>>
+    using state = sc::simple_state<MostDerived, Context, InnerInitial>;
+
+    template <class Derived, class InitialState>
+    struct machine : sc::asynchronous_state_machine<Derived, InitialState, SmaccScheduler, SmaccAllocator>
+    {
+        machine(my_context ctx)
+            : sc::asynchronous_state_machine<Derived, InitialState, SmaccScheduler, SmaccAllocator>(ctx)
+        {
+        }
+    };
+
+    static const char* name()
+    {
+        return "sc::simple_state";
+    }
+
+    template <class Machine>
+    static SmaccScheduler::processor_handle create(SmaccScheduler& scheduler, smacc::SignalDetector&)
+    {
+        return scheduler.create_processor<Machine>();
+    }
+};
+
+//------------------------------------------------------------------------------
+// events
+
+struct EvNext : sc::event<EvNext>
+{
+};
+
+template <int Region>
+struct EvNextIn : sc::event<EvNextIn<Region>>
+{
+};
+
+template <int Bit>
+struct EvFlipBit : sc::event<EvFlipBit<Bit>>
+{
+};
+
+template <template <int> class Event, int... I>
+std::vector<EventPtr> makeEvents(std::integer_sequence<int, I...>)
+{
+    return {EventPtr(new Event<I>())...};
+}
+
+//------------------------------------------------------------------------------
+// wide
+
+template <class Policy, int N>
+struct WideMachine;
+
+template <class Policy, int N, int I>
+struct WideState : Policy::template state<WideState<Policy, N, I>, WideMachine<Policy, N>>
+{
+    typedef typename Policy::template state<WideState, WideMachine<Policy, N>> state_base;
+    using state_base::state_base;
+
+    typedef sc::transition<EvNext, WideState<Policy, N, (I + 1) % N>> reactions;
+};
+
+template <class Policy, int N>
+struct WideMachine : Policy::template machine<WideMachine<Policy, N>, WideState<Policy, N, 0>>
+{
+    typedef typename Policy::template machine<WideMachine, WideState<Policy, N, 0>> machine_base;
+    using machine_base::machine_base;
+};
+
+template <int N>
+struct Wide
+{
+    static const int states = N;
+
+    template <class Policy>
+    using machine = WideMachine<Policy, N>;
+
+    static std::string name()
+    {
+        return "wide " + std::to_string(N);
+    }
+
+    // events of one period of the workload
+    static std::vector<EventPtr> events()
+    {
+        return {EventPtr(new EvNext())};
+    }
+};
+
+//------------------------------------------------------------------------------
+// deep
+
+template <class Policy, int D>
+struct DeepMachine;
+
+template <class Policy, int D, int I>
+struct DeepState;
+
+template <class Policy, int D, int I>
+struct DeepContext
+{
+    typedef DeepState<Policy, D, I - 1> type;
+};
+
+template <class Policy, int D>
+struct DeepContext<Policy, D, 0>
+{
+    typedef DeepMachine<Policy, D> type;
+};
+
+// the inner state is given in a list: a template state given alone would be instantiated by the
+// statechart (to check whether it is a sequence) before its context is complete
+template <class Policy, int D, int I, bool Leaf = (I + 1 == D)>
+struct DeepInner
+{
+    typedef mpl::list<DeepState<Policy, D, I + 1>> type;
+};
+
+template <class Policy, int D, int I>
+struct DeepInner<Policy, D, I, true>
+{
+    typedef mpl::list<> type;
+};
+
+template <class Policy, int D, int I>
+struct DeepState : Policy::template state<DeepState<Policy, D, I>, typename DeepContext<Policy, D, I>::type,
+                                          typename DeepInner<Policy, D, I>::type>
+{
+    typedef typename Policy::template state<DeepState, typename DeepContext<Policy, D, I>::type,
+                                            typename DeepInner<Policy, D, I>::type>
+        state_base;
+    using state_base::state_base;
+
+    // the event is forwarded from the leaf to the outermost state, that is exited and entered again
+    typedef typename std::conditional<I == 0, sc::transition<EvNext, DeepState>, mpl::list<>>::type reactions;
+};
+
+template <class Policy, int D>
+struct DeepMachine : Policy::template machine<DeepMachine<Policy, D>, DeepState<Policy, D, 0>>
+{
+    typedef typename Policy::template machine<DeepMachine, DeepState<Policy, D, 0>> machine_base;
+    using machine_base::machine_base;
+};
+
+template <int D>
+struct Deep
+{
+    static const int states = D;
+
+    template <class Policy>
+    using machine = DeepMachine<Policy, D>;
+
+    static std::string name()
+    {
+        return "deep " + std::to_string(D);
+    }
+
+    static std::vector<EventPtr> events()
+    {
+        return {EventPtr(new EvNext())};
+    }
+};
+
+//------------------------------------------------------------------------------
+// orthogonal
+
+template <class Policy, int K, int M>
+struct OrthogonalMachine;
+
+template <class Policy, int K, int M>
+struct OrthogonalRoot;
+
+template <class Policy, int K, int M, int R, int I>
+struct RegionState
+    : Policy::template state<RegionState<Policy, K, M, R, I>,
+                             typename OrthogonalRoot<Policy, K, M>::template orthogonal<R>>
+{
+    typedef typename Policy::template state<RegionState, typename OrthogonalRoot<Policy, K, M>::template orthogonal<R>>
+        state_base;
+    using state_base::state_base;
+
+    typedef sc::transition<EvNextIn<R>, RegionState<Policy, K, M, R, (I + 1) % M>> reactions;
+};
+
+template <class Policy, int K, int M, class Regions>
+struct RegionInitialStates;
+
+template <class Policy, int K, int M, int... R>
+struct RegionInitialStates<Policy, K, M, std::integer_sequence<int, R...>>
+{
+    typedef mpl::list<RegionState<Policy, K, M, R, 0>...> type;
+};
+
+template <class Policy, int K, int M>
+struct OrthogonalRoot
+    : Policy::template state<OrthogonalRoot<Policy, K, M>, OrthogonalMachine<Policy, K, M>,
+                             typename RegionInitialStates<Policy, K, M, std::make_integer_sequence<int, K>>::type>
+{
+    typedef typename Policy::template state<
+        OrthogonalRoot, OrthogonalMachine<Policy, K, M>,
+        typename RegionInitialStates<Policy, K, M, std::make_integer_sequence<int, K>>::type>
+        state_base;
+    using state_base::state_base;
+};
+
+template <class Policy, int K, int M>
+struct OrthogonalMachine : Policy::template machine<OrthogonalMachine<Policy, K, M>, OrthogonalRoot<Policy, K, M>>
+{
+    typedef typename Policy::template machine<OrthogonalMachine, OrthogonalRoot<Policy, K, M>> machine_base;
+    using machine_base::machine_base;
+};
+
+// K is limited by the size of the mpl::list of the inner initial states (20)
+template <int K, int M>
+struct Orthogonal
+{
+    static const int states = 1 + K * M;
+
+    template <class Policy>
+    using machine = OrthogonalMachine<Policy, K, M>;
+
+    static std::string name()
+    {
+        return "orthogonal " + std::to_string(K) + "x" + std::to_string(M);
+    }
+
+    static std::vector<EventPtr> events()
+    {
+        return makeEvents<EvNextIn>(std::make_integer_sequence<int, K>());
+    }
+};
+
+//------------------------------------------------------------------------------
+// bit machine
+
+template <class Policy, int B>
+struct BitMachine;
+
+template <class Policy, int B, unsigned S>
+struct BitState;
+
+template <class Policy, int B, unsigned S, class BitSequence>
+struct FlipTransitions;
+
+template <class Policy, int B, unsigned S, int... Bit>
+struct FlipTransitions<Policy, B, S, std::integer_sequence<int, Bit...>>
+{
+    typedef mpl::list<sc::transition<EvFlipBit<Bit>, BitState<Policy, B, (S ^ (1u << Bit))>>...> type;
+};
+
+template <class Policy, int B, unsigned S>
+struct BitState : Policy::template state<BitState<Policy, B, S>, BitMachine<Policy, B>>
+{
+    typedef typename Policy::template state<BitState, BitMachine<Policy, B>> state_base;
+    using state_base::state_base;
+
+    typedef typename FlipTransitions<Policy, B, S, std::make_integer_sequence<int, B>>::type reactions;
+};
+
+template <class Policy, int B>
+struct BitMachine : Policy::template machine<BitMachine<Policy, B>, BitState<Policy, B, 0>>
+{
+    typedef typename Policy::template machine<BitMachine, BitState<Policy, B, 0>> machine_base;
+    using machine_base::machine_base;
+};
+
+// B is limited by the size of the mpl::list of the reactions (20)
+template <int B>
+struct Bits
+{
+    static const int states = 1 << B;
+
+    template <class Policy>
+    using machine = BitMachine<Policy, B>;
+
+    static std::string name()
+    {
+        return "bitmachine " + std::to_string(B) + " bits";
+    }
+
+    // gray code: the flip i toggles the lowest bit set in i, the last one goes back to the state 0
+    static std::vector<EventPtr> events()
+    {
+        std::vector<EventPtr> flips = makeEvents<EvFlipBit>(std::make_integer_sequence<int, B>());
+
+        std::vector<EventPtr> ret;
+        for (unsigned i = 1; i < (1u << B); i++)
+        {
+            ret.push_back(flips[__builtin_ctz(i)]);
+        }
+        ret.push_back(flips[B - 1]);
+        return ret;
+    }
+};
+}
@@ -0,0 +1,105 @@
+#include <smacc_statechart_benchmark/statechart_benchmark.h>
+#include <ros/master.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <sys/resource.h>
+
+// The state machine and the state policy of each executable are selected when it is compiled (see
+// CMakeLists.txt), so the compile time and the size of the binary of each combination can be compared.
+#ifndef SYNTHETIC_SHAPE
+#define SYNTHETIC_SHAPE synthetic::Bits<6>
+#endif
+
+#ifndef SYNTHETIC_POLICY
+#define SYNTHETIC_POLICY synthetic::SmaccStates
+#endif
+
+// usage: <benchmark> [transitions] [startups]
+// default: 1000000 transitions and 10 startups
+
+//------------------------------------------------------------------------------
+// heap counters
+
+namespace
+{
+std::atomic<uint64_t> allocationCount(0);
+std::atomic<int64_t> allocatedBytes(0);
+}
+
+void* operator new(std::size_t size)
+{
+  void* ptr = std::malloc(size != 0 ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  if (ptr == nullptr)
+    return;
+
+  allocatedBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+namespace synthetic
+{
+uint64_t heapAllocations()
+{
+  return allocationCount.load(std::memory_order_relaxed);
+}
+
+int64_t heapBytes()
+{
+  return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+int64_t peakResidentMemory()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss * 1024;
+}
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "synthetic_statechart_benchmark", ros::init_options::NoRosout | ros::init_options::AnonymousName);
+
+  uint64_t transitions = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  int startups = argc > 2 ? atoi(argv[2]) : 10;
+
+  // no roscore: the states do not write parameters and the master calls fail at once
+  smacc::setOfflineMode(true);
+  ros::master::setRetryTimeout(ros::WallDuration(0.01));
+  smacc::SmaccAllocationStats::setHeapAllocationCounter(&synthetic::heapAllocations);
+
+  if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Error))
+  {
+    ros::console::notifyLoggerLevelsChanged();
+  }
+
+  synthetic::BenchmarkResult result =
+      synthetic::runStatechartBenchmark<SYNTHETIC_SHAPE, SYNTHETIC_POLICY>(transitions, startups);
+
+  std::stringstream ss;
+  result.toString(ss);
+  std::cout << ss.str() << std::endl;
+  std::cout << " peak resident memory: " << synthetic::peakResidentMemory() / 1024 << " KiB" << std::endl;
+  return 0;
+}
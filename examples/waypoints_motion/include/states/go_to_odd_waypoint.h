@@ -26,6 +26,15 @@ public:
   // reference the parent context parameter constructor
   using SmaccState::SmaccState;
 
+  // the components of the inner states, created and connected when the state machine starts
+  static void declareComponents(smacc::ComponentDeclarations& components)
+  {
+    components.add<smacc::SmaccMoveBaseActionClient>("move_base");
+    components.add<smacc_odom_tracker::OdomTracker>();
+    components.add<smacc_planner_switcher::PlannerSwitcher>("move_base");
+    components.add<smacc::SmaccToolActionClient>("tool_action_server");
+  }
+
   void onEntry()
   {
       ROS_INFO("-------");
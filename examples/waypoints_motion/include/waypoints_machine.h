@@ -5,6 +5,7 @@
 #include <smacc_tool_plugin_template/smacc_tool_plugin.h>
 #include <smacc_odom_tracker/odom_tracker.h>
 #include <smacc_planner_switcher/planner_switcher.h>
+#include <stdexcept>
 using namespace smacc;
 
 // ----- STATES FORWARD DECLARATIONS ---
@@ -34,10 +35,28 @@ WayPointsStateMachine(my_context ctx, SignalDetector *signalDetector)
     this->setGlobalSMData("waypoint_index", currentWayPointIndex);
 }
 
+ // offline mode (replay and benchmark): there is no parameter server, the tool that runs the state machine
+ // sets the waypoints here (ie: loaded from config/waypoints_motion_sm_config.yaml)
+ static XmlRpc::XmlRpcValue& offlineWaypoints()
+ {
+    static XmlRpc::XmlRpcValue waypoints;
+    return waypoints;
+ }
+
  void loadWayPointsFromParameterServer()
  {
     XmlRpc::XmlRpcValue waypointsList;
-    this->getParam("waypoints", waypointsList);
+    if (!this->getParam("waypoints", waypointsList))
+    {
+        if (!smacc::isOfflineMode() || !offlineWaypoints().valid())
+        {
+            ROS_FATAL("WayPointsStateMachine: the waypoints parameter is missing (see config/waypoints_motion_sm_config.yaml)");
+            throw std::runtime_error("WayPointsStateMachine: the waypoints parameter is missing");
+        }
+
+        waypointsList = offlineWaypoints();
+    }
+
     ROS_ASSERT(waypointsList.getType() == XmlRpc::XmlRpcValue::TypeArray);
     
     auto waypoints = std::make_shared<std::vector<geometry_msgs::Point>>();
@@ -0,0 +1,202 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Compares the previous requiresComponent lookup (mutex + demangled type name + std::map + dynamic_cast)
+// against smacc::TypeIndexedRegistry:
+//  - lookup: cost of one lookup of an existing component
+//  - transitions: transitions/sec of a state machine whose states require 3 components on entry
+//    (as the states of the radial motion and waypoints examples)
+#include <smacc/component_registry.h>
+
+#include <boost/core/demangle.hpp>
+#include <boost/statechart/event.hpp>
+#include <boost/statechart/state.hpp>
+#include <boost/statechart/state_machine.hpp>
+#include <boost/statechart/transition.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace sc = boost::statechart;
+typedef std::chrono::steady_clock Clock;
+
+struct Component
+{
+  virtual ~Component()
+  {
+  }
+};
+
+template <int N>
+struct FakeComponent : Component
+{
+};
+
+typedef FakeComponent<0> MoveBaseClient;
+typedef FakeComponent<1> OdomTracker;
+typedef FakeComponent<2> PlannerSwitcher;
+
+// the component storage of ISmaccStateMachine before the TypeIndexedRegistry
+class MapComponents
+{
+public:
+  template <typename T>
+  void requiresComponent(T*& storage)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string key = boost::core::demangle(typeid(T).name());
+    auto it = components_.find(key);
+    if (it == components_.end())
+    {
+      T* ret = new T();
+      components_[key] = ret;
+      storage = ret;
+    }
+    else
+    {
+      storage = dynamic_cast<T*>(it->second);
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::map<std::string, Component*> components_;
+};
+
+class RegistryComponents
+{
+public:
+  template <typename T>
+  void requiresComponent(T*& storage)
+  {
+    storage = registry_.template getOrCreate<T>([]() { return new T(); });
+  }
+
+private:
+  smacc::TypeIndexedRegistry<Component> registry_;
+};
+
+// fills the storages with some component types that are not used, as a real application
+template <typename Components>
+void populate(Components& components)
+{
+  FakeComponent<10>* c10;
+  FakeComponent<11>* c11;
+  FakeComponent<12>* c12;
+  FakeComponent<13>* c13;
+  FakeComponent<14>* c14;
+  components.requiresComponent(c10);
+  components.requiresComponent(c11);
+  components.requiresComponent(c12);
+  components.requiresComponent(c13);
+  components.requiresComponent(c14);
+}
+
+template <typename Components>
+double runLookup(unsigned long lookups)
+{
+  Components components;
+  populate(components);
+
+  MoveBaseClient* client;
+  components.requiresComponent(client);
+
+  auto start = Clock::now();
+  for (unsigned long i = 0; i < lookups; i++)
+  {
+    components.requiresComponent(client);
+    asm volatile("" : : "r"(client) : "memory");
+  }
+
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lookups;
+}
+
+struct EvNext : sc::event<EvNext>
+{
+};
+
+template <typename Components>
+struct StateA;
+template <typename Components>
+struct StateB;
+
+template <typename Components>
+struct TransitionMachine : sc::state_machine<TransitionMachine<Components>, StateA<Components>>, Components
+{
+};
+
+template <typename Components, typename Derived, typename Next>
+struct NavigationState : sc::state<Derived, TransitionMachine<Components>>
+{
+  typedef sc::state<Derived, TransitionMachine<Components>> base_type;
+  typedef sc::transition<EvNext, Next> reactions;
+
+  NavigationState(typename base_type::my_context ctx) : base_type(ctx)
+  {
+    auto& machine = this->outermost_context();
+    machine.requiresComponent(moveBaseClient_);
+    machine.requiresComponent(odomTracker_);
+    machine.requiresComponent(plannerSwitcher_);
+  }
+
+  MoveBaseClient* moveBaseClient_;
+  OdomTracker* odomTracker_;
+  PlannerSwitcher* plannerSwitcher_;
+};
+
+template <typename Components>
+struct StateA : NavigationState<Components, StateA<Components>, StateB<Components>>
+{
+  typedef NavigationState<Components, StateA<Components>, StateB<Components>> base_type;
+  using base_type::base_type;
+};
+
+template <typename Components>
+struct StateB : NavigationState<Components, StateB<Components>, StateA<Components>>
+{
+  typedef NavigationState<Components, StateB<Components>, StateA<Components>> base_type;
+  using base_type::base_type;
+};
+
+template <typename Components>
+double runTransitions(unsigned long transitions)
+{
+  TransitionMachine<Components> machine;
+  populate(machine);
+  machine.initiate();
+
+  const EvNext ev;
+  auto start = Clock::now();
+  for (unsigned long i = 0; i < transitions; i++)
+  {
+    machine.process_event(ev);
+  }
+
+  return transitions / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+  unsigned long count = 2000000;
+  if (argc > 1)
+    count = std::stoul(argv[1]);
+
+  double mapLookup = runLookup<MapComponents>(count);
+  double registryLookup = runLookup<RegistryComponents>(count);
+  std::cout << "---- lookup (ns) ----" << std::endl;
+  std::cout << "  map: " << mapLookup << " registry: " << registryLookup << " (x" << mapLookup / registryLookup << ")"
+            << std::endl;
+
+  double mapTransitions = runTransitions<MapComponents>(count / 4);
+  double registryTransitions = runTransitions<RegistryComponents>(count / 4);
+  std::cout << "---- transitions/sec (3 components required on entry) ----" << std::endl;
+  std::cout << "  map: " << (long)mapTransitions << " registry: " << (long)registryTransitions << " (x"
+            << registryTransitions / mapTransitions << ")" << std::endl;
+
+  return 0;
+}
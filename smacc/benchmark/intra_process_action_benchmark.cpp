@@ -0,0 +1,188 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Compares the intra-process action transport (smacc::IntraProcessActionServer) against actionlib when the
+// action server lives in the same process as the client:
+//  - round trip: time from sendGoal until the done callback, the server publishes N feedback messages
+//    before the result
+//  - throughput: goals/sec and feedback messages/sec
+// The actionlib part needs a roscore (it is skipped otherwise). Its server is in this process too, so it
+// is a lower bound of the cost of a server node (no context switch to other process)
+#include <smacc/intra_process_action_server.h>
+
+#include <actionlib/TestAction.h>
+#include <actionlib/client/simple_action_client.h>
+#include <actionlib/server/simple_action_server.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+typedef actionlib::SimpleClientGoalState SimpleClientGoalState;
+
+// the client side waits for the done callback of each goal
+struct GoalWaiter
+{
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool done = false;
+  std::atomic<unsigned long> feedback{ 0 };
+
+  void onFeedback(const actionlib::TestFeedbackConstPtr&)
+  {
+    feedback.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void onDone(const SimpleClientGoalState&, const actionlib::TestResultConstPtr&)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    condition.notify_one();
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]() { return done; });
+    done = false;
+  }
+};
+
+struct BenchmarkResult
+{
+  std::vector<double> latencies;
+  double elapsed;
+  unsigned long feedback;
+};
+
+template <typename Server>
+void executeGoal(Server& server, const actionlib::TestGoalConstPtr& goal, int feedbackPerGoal)
+{
+  actionlib::TestFeedback feedback;
+  for (int i = 0; i < feedbackPerGoal; i++)
+  {
+    feedback.feedback = i;
+    server.publishFeedback(feedback);
+  }
+
+  actionlib::TestResult result;
+  result.result = goal->goal;
+  server.setSucceeded(result);
+}
+
+BenchmarkResult runIntraProcess(int goals, int feedbackPerGoal)
+{
+  typedef smacc::IntraProcessActionServer<actionlib::TestAction> Server;
+  Server* serverPtr = nullptr;
+  Server server("smacc_benchmark_intra_process",
+                [&](const actionlib::TestGoalConstPtr& goal) { executeGoal(*serverPtr, goal, feedbackPerGoal); }, false);
+  serverPtr = &server;
+  server.start();
+
+  GoalWaiter waiter;
+  BenchmarkResult ret;
+  ret.latencies.reserve(goals);
+
+  auto start = Clock::now();
+  for (int i = 0; i < goals; i++)
+  {
+    auto goal = boost::make_shared<actionlib::TestGoal>();
+    goal->goal = i;
+
+    auto sendTime = Clock::now();
+    Server::sendGoal(server.getName(), goal, boost::bind(&GoalWaiter::onFeedback, &waiter, _1),
+                     boost::bind(&GoalWaiter::onDone, &waiter, _1, _2));
+    waiter.wait();
+    ret.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sendTime).count());
+  }
+  ret.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  ret.feedback = waiter.feedback;
+
+  std::sort(ret.latencies.begin(), ret.latencies.end());
+  return ret;
+}
+
+BenchmarkResult runActionlib(int goals, int feedbackPerGoal)
+{
+  typedef actionlib::SimpleActionServer<actionlib::TestAction> Server;
+  typedef actionlib::SimpleActionClient<actionlib::TestAction> Client;
+
+  ros::NodeHandle nh;
+  ros::AsyncSpinner spinner(2);
+  spinner.start();
+
+  Server* serverPtr = nullptr;
+  Server server(nh, "smacc_benchmark_actionlib",
+                [&](const actionlib::TestGoalConstPtr& goal) { executeGoal(*serverPtr, goal, feedbackPerGoal); }, false);
+  serverPtr = &server;
+  server.start();
+
+  Client client(nh, "smacc_benchmark_actionlib", false);
+  client.waitForServer(ros::Duration(5.0));
+
+  GoalWaiter waiter;
+  BenchmarkResult ret;
+  ret.latencies.reserve(goals);
+
+  auto start = Clock::now();
+  for (int i = 0; i < goals; i++)
+  {
+    actionlib::TestGoal goal;
+    goal.goal = i;
+
+    auto sendTime = Clock::now();
+    client.sendGoal(goal, boost::bind(&GoalWaiter::onDone, &waiter, _1, _2), Client::SimpleActiveCallback(),
+                    boost::bind(&GoalWaiter::onFeedback, &waiter, _1));
+    waiter.wait();
+    ret.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sendTime).count());
+  }
+  ret.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  ret.feedback = waiter.feedback;
+
+  spinner.stop();
+  std::sort(ret.latencies.begin(), ret.latencies.end());
+  return ret;
+}
+
+void printResult(const std::string& name, const BenchmarkResult& result)
+{
+  const auto& latencies = result.latencies;
+  double sum = 0;
+  for (double l : latencies)
+    sum += l;
+
+  std::cout << "  " << name << ": round trip mean " << sum / latencies.size() << " us, p50 "
+            << latencies[latencies.size() / 2] << " us, p99 " << latencies[latencies.size() * 99 / 100]
+            << " us | " << (long)(latencies.size() / result.elapsed) << " goals/sec, "
+            << (long)(result.feedback / result.elapsed) << " feedback/sec" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "smacc_intra_process_action_benchmark", ros::init_options::AnonymousName);
+
+  int goals = 1000;
+  if (argc > 1)
+    goals = std::stoi(argv[1]);
+
+  for (int feedbackPerGoal : { 0, 10, 100 })
+  {
+    std::cout << "---- " << goals << " goals, " << feedbackPerGoal << " feedback messages per goal ----" << std::endl;
+    printResult("intra-process", runIntraProcess(goals, feedbackPerGoal));
+
+    if (ros::master::check())
+      printResult("actionlib", runActionlib(goals, feedbackPerGoal));
+    else
+      std::cout << "  actionlib: skipped (no roscore)" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Compares sc::fifo_scheduler<> (single fifo) against smacc::PriorityScheduler<> (event lanes) when an
+// action server floods the state machine with feedback:
+//  - result latency: time from queue_event of the result until the reaction, with a burst of feedback
+//    events queued just before it
+//  - throughput: events/sec of a single producer (cost of the lanes when there is no priority)
+#include <smacc/priority_scheduler.h>
+
+#include <boost/statechart/asynchronous_state_machine.hpp>
+#include <boost/statechart/custom_reaction.hpp>
+#include <boost/statechart/event.hpp>
+#include <boost/statechart/fifo_scheduler.hpp>
+#include <boost/statechart/simple_state.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace sc = boost::statechart;
+typedef std::chrono::steady_clock Clock;
+
+struct EvFeedback : sc::event<EvFeedback>
+{
+};
+
+struct EvResult : sc::event<EvResult>
+{
+  Clock::time_point postTime;
+};
+
+template <typename Scheduler>
+struct BenchmarkState;
+
+template <typename Scheduler>
+struct BenchmarkMachine : sc::asynchronous_state_machine<BenchmarkMachine<Scheduler>, BenchmarkState<Scheduler>, Scheduler>
+{
+  typedef sc::asynchronous_state_machine<BenchmarkMachine<Scheduler>, BenchmarkState<Scheduler>, Scheduler> base_type;
+
+  BenchmarkMachine(typename base_type::my_context ctx, std::atomic<unsigned long>* results, std::vector<double>* latencies,
+                   int feedbackMicroseconds)
+    : base_type(ctx), results_(results), latencies_(latencies), feedbackMicroseconds_(feedbackMicroseconds)
+  {
+  }
+
+  std::atomic<unsigned long>* results_;
+  std::vector<double>* latencies_;
+  int feedbackMicroseconds_;
+};
+
+template <typename Scheduler>
+struct BenchmarkState : sc::simple_state<BenchmarkState<Scheduler>, BenchmarkMachine<Scheduler>>
+{
+  typedef boost::mpl::list<sc::custom_reaction<EvFeedback>, sc::custom_reaction<EvResult>> reactions;
+
+  // the feedback reaction does some work (ie: it updates a progress estimation)
+  sc::result react(const EvFeedback&)
+  {
+    auto end = Clock::now() + std::chrono::microseconds(this->outermost_context().feedbackMicroseconds_);
+    while (Clock::now() < end)
+    {
+    }
+    return this->discard_event();
+  }
+
+  sc::result react(const EvResult& ev)
+  {
+    auto& machine = this->outermost_context();
+    machine.latencies_->push_back(std::chrono::duration<double, std::micro>(Clock::now() - ev.postTime).count());
+    machine.results_->fetch_add(1, std::memory_order_release);
+    return this->discard_event();
+  }
+};
+
+template <typename Scheduler>
+std::vector<double> runResultLatency(int samples, int burst, int feedbackMicroseconds)
+{
+  Scheduler scheduler(true);
+  std::atomic<unsigned long> results(0);
+  std::vector<double> latencies;
+  latencies.reserve(samples);
+
+  auto processor =
+      scheduler.template create_processor<BenchmarkMachine<Scheduler>>(&results, &latencies, feedbackMicroseconds);
+  scheduler.initiate_processor(processor);
+  boost::thread worker(boost::bind(&Scheduler::operator(), &scheduler, 0));
+
+  boost::intrusive_ptr<EvFeedback> feedback = new EvFeedback();
+  for (int i = 0; i < samples; i++)
+  {
+    for (int j = 0; j < burst; j++)
+    {
+      smacc::queueEvent(scheduler, processor, feedback, smacc::EventLane::FEEDBACK);
+    }
+
+    boost::intrusive_ptr<EvResult> result = new EvResult();
+    result->postTime = Clock::now();
+    smacc::queueEvent(scheduler, processor, result, smacc::EventLane::RESULT);
+
+    while (results.load(std::memory_order_acquire) < (unsigned long)(i + 1))
+    {
+      boost::this_thread::yield();
+    }
+  }
+
+  scheduler.terminate();
+  worker.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  return latencies;
+}
+
+template <typename Scheduler>
+double runThroughput(unsigned long events)
+{
+  Scheduler scheduler(true);
+  std::atomic<unsigned long> results(0);
+  std::vector<double> latencies;
+  latencies.reserve(events);
+
+  auto processor = scheduler.template create_processor<BenchmarkMachine<Scheduler>>(&results, &latencies, 0);
+  scheduler.initiate_processor(processor);
+  boost::thread worker(boost::bind(&Scheduler::operator(), &scheduler, 0));
+
+  auto start = Clock::now();
+  for (unsigned long i = 0; i < events; i++)
+  {
+    boost::intrusive_ptr<EvResult> result = new EvResult();
+    result->postTime = Clock::now();
+    scheduler.queue_event(processor, result);
+  }
+
+  while (results.load(std::memory_order_acquire) < events)
+  {
+    boost::this_thread::yield();
+  }
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  scheduler.terminate();
+  worker.join();
+
+  return events / elapsed;
+}
+
+void printLatencies(const std::string& name, const std::vector<double>& latencies)
+{
+  double sum = 0;
+  for (double l : latencies)
+    sum += l;
+
+  std::cout << "  " << name << ": mean " << sum / latencies.size() << " us, p50 " << latencies[latencies.size() / 2]
+            << " us, p99 " << latencies[latencies.size() * 99 / 100] << " us, max " << latencies.back() << " us"
+            << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  typedef sc::fifo_scheduler<> FifoScheduler;
+  typedef smacc::PriorityScheduler<> PriorityScheduler;
+
+  int samples = 200;
+  if (argc > 1)
+    samples = std::stoi(argv[1]);
+
+  std::cout << "---- result latency (feedback reaction: 10 us) ----" << std::endl;
+  for (int burst : { 0, 10, 100 })
+  {
+    std::cout << " feedback events queued before the result: " << burst << std::endl;
+    printLatencies("fifo_scheduler", runResultLatency<FifoScheduler>(samples, burst, 10));
+    printLatencies("priority_scheduler", runResultLatency<PriorityScheduler>(samples, burst, 10));
+  }
+
+  std::cout << "---- throughput (events/sec, single lane) ----" << std::endl;
+  double fifo = runThroughput<FifoScheduler>(samples * 1000);
+  double priority = runThroughput<PriorityScheduler>(samples * 1000);
+  std::cout << "  fifo_scheduler: " << (long)fifo << " priority_scheduler: " << (long)priority << " (x"
+            << priority / fifo << ")" << std::endl;
+
+  return 0;
+}
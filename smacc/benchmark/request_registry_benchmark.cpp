@@ -0,0 +1,190 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Compares the previous SignalDetector open request list (std::vector + mutex, linear find/erase) against
+// smacc::RequestRegistry with 1k-10k open requests:
+//  - churn: cost of finalizing one request and registering a new one (one goal completes, other is sent)
+//  - poll: cost of one polling round over all the open requests
+//  - concurrent: churn from several state machine threads while the signal detector thread polls
+#include <smacc/request_registry.h>
+
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct FakeClient : smacc::RequestRegistryEntry
+{
+  FakeClient() : polled(0)
+  {
+  }
+
+  std::atomic<unsigned long> polled;
+};
+
+// the open request list of the signal detector before the RequestRegistry
+class VectorRequestList
+{
+public:
+  bool add(FakeClient* client)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    requests_.push_back(client);
+    return true;
+  }
+
+  bool remove(FakeClient* client)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    auto it = std::find(requests_.begin(), requests_.end(), client);
+    if (it == requests_.end())
+      return false;
+
+    requests_.erase(it);
+    return true;
+  }
+
+  template <typename Function>
+  void forEach(Function f)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    for (auto* client : requests_)
+      f(client);
+  }
+
+private:
+  std::vector<FakeClient*> requests_;
+  std::recursive_mutex mutex_;
+};
+
+typedef smacc::RequestRegistry<FakeClient> Registry;
+
+template <typename List>
+double runChurn(List& list, std::vector<FakeClient>& clients, int openRequests, unsigned long operations)
+{
+  for (int i = 0; i < openRequests; i++)
+    list.add(&clients[i]);
+
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> pick(0, openRequests - 1);
+
+  auto start = Clock::now();
+  for (unsigned long i = 0; i < operations; i++)
+  {
+    FakeClient* client = &clients[pick(random)];
+    list.remove(client);
+    list.add(client);
+  }
+  double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  for (int i = 0; i < openRequests; i++)
+    list.remove(&clients[i]);
+
+  return elapsed / operations;
+}
+
+template <typename List>
+double runPoll(List& list, std::vector<FakeClient>& clients, int openRequests, int rounds)
+{
+  for (int i = 0; i < openRequests; i++)
+    list.add(&clients[i]);
+
+  auto start = Clock::now();
+  for (int r = 0; r < rounds; r++)
+  {
+    list.forEach([](FakeClient* client) { client->polled.fetch_add(1, std::memory_order_relaxed); });
+  }
+  double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  for (int i = 0; i < openRequests; i++)
+    list.remove(&clients[i]);
+
+  return elapsed / rounds;
+}
+
+// returns the churn operations per second while the poller thread iterates the list
+template <typename List>
+double runConcurrent(List& list, std::vector<FakeClient>& clients, int openRequests, int threads,
+                     unsigned long operationsPerThread)
+{
+  for (int i = 0; i < openRequests; i++)
+    list.add(&clients[i]);
+
+  std::atomic<bool> done(false);
+  boost::thread poller([&]() {
+    while (!done)
+    {
+      list.forEach([](FakeClient* client) { client->polled.fetch_add(1, std::memory_order_relaxed); });
+    }
+  });
+
+  // each thread owns a disjoint subset of the clients (each client belongs to one state machine)
+  auto start = Clock::now();
+  std::vector<boost::thread> workers;
+  for (int t = 0; t < threads; t++)
+  {
+    workers.emplace_back([&, t]() {
+      std::mt19937 random(t);
+      std::uniform_int_distribution<int> pick(0, openRequests / threads - 1);
+      for (unsigned long i = 0; i < operationsPerThread; i++)
+      {
+        FakeClient* client = &clients[pick(random) * threads + t];
+        list.remove(client);
+        list.add(client);
+      }
+    });
+  }
+
+  for (auto& w : workers)
+    w.join();
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  done = true;
+  poller.join();
+
+  for (int i = 0; i < openRequests; i++)
+    list.remove(&clients[i]);
+
+  return threads * operationsPerThread / elapsed;
+}
+
+int main(int argc, char** argv)
+{
+  unsigned long operations = 20000;
+  if (argc > 1)
+    operations = std::stoul(argv[1]);
+
+  for (int openRequests : { 1000, 5000, 10000 })
+  {
+    std::vector<FakeClient> clients(openRequests);
+    VectorRequestList vectorList;
+    Registry registry;
+
+    std::cout << "---- open requests: " << openRequests << " ----" << std::endl;
+
+    double vectorChurn = runChurn(vectorList, clients, openRequests, operations);
+    double registryChurn = runChurn(registry, clients, openRequests, operations);
+    std::cout << "  churn (ns/op)      vector: " << vectorChurn << " registry: " << registryChurn << " (x"
+              << vectorChurn / registryChurn << ")" << std::endl;
+
+    double vectorPoll = runPoll(vectorList, clients, openRequests, 1000);
+    double registryPoll = runPoll(registry, clients, openRequests, 1000);
+    std::cout << "  poll round (us)    vector: " << vectorPoll << " registry: " << registryPoll << std::endl;
+
+    double vectorConcurrent = runConcurrent(vectorList, clients, openRequests, 4, operations / 4);
+    double registryConcurrent = runConcurrent(registry, clients, openRequests, 4, operations / 4);
+    std::cout << "  concurrent (op/s)  vector: " << (long)vectorConcurrent << " registry: " << (long)registryConcurrent
+              << " (x" << registryConcurrent / vectorConcurrent << ")" << std::endl;
+  }
+
+  return 0;
+}
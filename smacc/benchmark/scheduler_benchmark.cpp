@@ -0,0 +1,180 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Compares sc::fifo_scheduler<> (mutex + condition variable fifo_worker) against
+// sc::fifo_scheduler<smacc::LockFreeFifoWorker<>>:
+//  - throughput: events/sec when several producer threads flood one state machine
+//  - wake-up latency: time from queue_event until the reaction when the worker thread is idle
+#include <smacc/lockfree_fifo_worker.h>
+
+#include <boost/statechart/asynchronous_state_machine.hpp>
+#include <boost/statechart/custom_reaction.hpp>
+#include <boost/statechart/event.hpp>
+#include <boost/statechart/fifo_scheduler.hpp>
+#include <boost/statechart/simple_state.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace sc = boost::statechart;
+typedef std::chrono::steady_clock Clock;
+
+struct EvBenchmark : sc::event<EvBenchmark>
+{
+  Clock::time_point postTime;
+};
+
+template <typename Scheduler>
+struct BenchmarkState;
+
+template <typename Scheduler>
+struct BenchmarkMachine : sc::asynchronous_state_machine<BenchmarkMachine<Scheduler>, BenchmarkState<Scheduler>, Scheduler>
+{
+  typedef sc::asynchronous_state_machine<BenchmarkMachine<Scheduler>, BenchmarkState<Scheduler>, Scheduler> base_type;
+
+  BenchmarkMachine(typename base_type::my_context ctx, std::atomic<unsigned long>* counter, std::vector<double>* latencies)
+    : base_type(ctx), counter_(counter), latencies_(latencies)
+  {
+  }
+
+  std::atomic<unsigned long>* counter_;
+  std::vector<double>* latencies_;
+};
+
+template <typename Scheduler>
+struct BenchmarkState : sc::simple_state<BenchmarkState<Scheduler>, BenchmarkMachine<Scheduler>>
+{
+  typedef sc::custom_reaction<EvBenchmark> reactions;
+
+  sc::result react(const EvBenchmark& ev)
+  {
+    auto& machine = this->outermost_context();
+    if (machine.latencies_ != nullptr)
+    {
+      machine.latencies_->push_back(std::chrono::duration<double, std::micro>(Clock::now() - ev.postTime).count());
+    }
+
+    machine.counter_->fetch_add(1, std::memory_order_release);
+    return this->discard_event();
+  }
+};
+
+template <typename Scheduler>
+double runThroughput(int producerCount, unsigned long eventsPerProducer)
+{
+  Scheduler scheduler(true);
+  std::atomic<unsigned long> counter(0);
+
+  auto processor = scheduler.template create_processor<BenchmarkMachine<Scheduler>>(&counter, (std::vector<double>*)nullptr);
+  scheduler.initiate_processor(processor);
+  boost::thread worker(boost::bind(&Scheduler::operator(), &scheduler, 0));
+
+  boost::intrusive_ptr<EvBenchmark> ev = new EvBenchmark();
+  unsigned long total = producerCount * eventsPerProducer;
+
+  auto start = Clock::now();
+  std::vector<boost::thread> producers;
+  for (int i = 0; i < producerCount; i++)
+  {
+    producers.emplace_back([&]() {
+      for (unsigned long j = 0; j < eventsPerProducer; j++)
+      {
+        scheduler.queue_event(processor, ev);
+      }
+    });
+  }
+
+  for (auto& p : producers)
+    p.join();
+
+  while (counter.load(std::memory_order_acquire) < total)
+  {
+    boost::this_thread::yield();
+  }
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  scheduler.terminate();
+  worker.join();
+
+  return total / elapsed;
+}
+
+template <typename Scheduler>
+std::vector<double> runWakeUpLatency(int samples, int idleMicroseconds)
+{
+  Scheduler scheduler(true);
+  std::atomic<unsigned long> counter(0);
+  std::vector<double> latencies;
+  latencies.reserve(samples);
+
+  auto processor = scheduler.template create_processor<BenchmarkMachine<Scheduler>>(&counter, &latencies);
+  scheduler.initiate_processor(processor);
+  boost::thread worker(boost::bind(&Scheduler::operator(), &scheduler, 0));
+
+  for (int i = 0; i < samples; i++)
+  {
+    // let the worker thread go idle (spin, yield or park depending on the worker)
+    boost::this_thread::sleep_for(boost::chrono::microseconds(idleMicroseconds));
+
+    boost::intrusive_ptr<EvBenchmark> ev = new EvBenchmark();
+    ev->postTime = Clock::now();
+    scheduler.queue_event(processor, ev);
+
+    while (counter.load(std::memory_order_acquire) < (unsigned long)(i + 1))
+    {
+      boost::this_thread::yield();
+    }
+  }
+
+  scheduler.terminate();
+  worker.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  return latencies;
+}
+
+void printLatencies(const std::string& name, const std::vector<double>& latencies)
+{
+  double sum = 0;
+  for (double l : latencies)
+    sum += l;
+
+  std::cout << "  " << name << ": mean " << sum / latencies.size() << " us, p50 " << latencies[latencies.size() / 2]
+            << " us, p99 " << latencies[latencies.size() * 99 / 100] << " us, max " << latencies.back() << " us"
+            << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  typedef sc::fifo_scheduler<> FifoScheduler;
+  typedef sc::fifo_scheduler<smacc::LockFreeFifoWorker<>> LockFreeScheduler;
+
+  unsigned long eventsPerProducer = 200000;
+  if (argc > 1)
+    eventsPerProducer = std::stoul(argv[1]);
+
+  std::cout << "---- throughput (events/sec) ----" << std::endl;
+  for (int producers : { 1, 2, 4 })
+  {
+    double fifo = runThroughput<FifoScheduler>(producers, eventsPerProducer);
+    double lockfree = runThroughput<LockFreeScheduler>(producers, eventsPerProducer);
+    std::cout << "  producers: " << producers << " fifo_worker: " << (long)fifo
+              << " lockfree_worker: " << (long)lockfree << " (x" << lockfree / fifo << ")" << std::endl;
+  }
+
+  std::cout << "---- wake-up latency ----" << std::endl;
+  for (int idle : { 10, 1000 })
+  {
+    std::cout << " idle period: " << idle << " us" << std::endl;
+    printLatencies("fifo_worker", runWakeUpLatency<FifoScheduler>(2000, idle));
+    printLatencies("lockfree_worker", runWakeUpLatency<LockFreeScheduler>(2000, idle));
+  }
+
+  return 0;
+}
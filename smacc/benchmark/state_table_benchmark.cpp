@@ -0,0 +1,186 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Startup cost of the state table of a synthetic state machine with 500 states (50 containers with
+// 9 inner states each):
+//  - names: demangled names (abi::__cxa_demangle + boost::split, as the previous SmaccStateMachineInfo)
+//    against the compiler generated names of smacc::typeName
+//  - table: cost of building the table the first time and once the names are cached
+//  - instance: cost for each new state machine instance, that now shares the table of its type
+#include <smacc/state_table_builder.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/core/demangle.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/statechart/event.hpp>
+#include <boost/statechart/simple_state.hpp>
+#include <boost/statechart/state_machine.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace sc = boost::statechart;
+typedef std::chrono::steady_clock Clock;
+
+const int CONTAINERS = 50;
+const int LEAVES = 9;
+
+struct EvNext : sc::event<EvNext>
+{
+};
+
+struct EvStep : sc::event<EvStep>
+{
+};
+
+template <int C>
+struct Container;
+
+template <int C, int I>
+struct Leaf;
+
+struct Machine : sc::state_machine<Machine, Container<0>>
+{
+};
+
+// the inner initial state is given in a list, otherwise mpl would instantiate the (template) leaf
+// before its container is complete
+template <int C>
+struct Container : sc::simple_state<Container<C>, Machine, boost::mpl::list<Leaf<C, 0>>>
+{
+  typedef sc::transition<EvNext, Container<(C + 1) % CONTAINERS>> reactions;
+  boost::mpl::list<Leaf<C, 0>>* smacc_inner_type;
+};
+
+template <int C, int I>
+struct Leaf : sc::simple_state<Leaf<C, I>, Container<C>>
+{
+  typedef sc::transition<EvStep, Leaf<C, (I + 1) % LEAVES>> reactions;
+  boost::mpl::list<>* smacc_inner_type;
+};
+
+template <typename T>
+struct Tag
+{
+  typedef T type;
+};
+
+// calls f(Tag<State>()) for each state of the synthetic machine
+template <int C, int I>
+struct LeafVisitor
+{
+  template <typename Function>
+  static void visit(Function& f)
+  {
+    f(Tag<Leaf<C, I>>());
+    LeafVisitor<C, I + 1>::visit(f);
+  }
+};
+
+template <int C>
+struct LeafVisitor<C, LEAVES>
+{
+  template <typename Function>
+  static void visit(Function&)
+  {
+  }
+};
+
+template <int C>
+struct StateVisitor
+{
+  template <typename Function>
+  static void visit(Function& f)
+  {
+    f(Tag<Container<C>>());
+    LeafVisitor<C, 0>::visit(f);
+    StateVisitor<C + 1>::visit(f);
+  }
+};
+
+template <>
+struct StateVisitor<CONTAINERS>
+{
+  template <typename Function>
+  static void visit(Function&)
+  {
+  }
+};
+
+double elapsedMicros(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+  int instances = 1000;
+  if (argc > 1)
+    instances = std::stoi(argv[1]);
+
+  std::size_t checksum = 0;
+
+  // ---- names ----
+  auto start = Clock::now();
+  auto legacyNames = [&](auto tag) {
+    typedef typename decltype(tag)::type State;
+    std::vector<std::string> strs;
+    std::string demangled = boost::core::demangle(typeid(State).name());
+    boost::split(strs, demangled, boost::is_any_of(":"));
+    checksum += strs.back().size();
+  };
+  StateVisitor<0>::visit(legacyNames);
+  double legacyNamesTime = elapsedMicros(start);
+
+  start = Clock::now();
+  auto generatedNames = [&](auto tag) {
+    typedef typename decltype(tag)::type State;
+    checksum += smacc::shortTypeName<State>().size();
+  };
+  StateVisitor<0>::visit(generatedNames);
+  double generatedNamesTime = elapsedMicros(start);
+
+  // ---- table ----
+  start = Clock::now();
+  smacc::SmaccStateTable table;
+  smacc::buildStateTable<Container<0>>(table);
+  double firstBuildTime = elapsedMicros(start);
+
+  start = Clock::now();
+  smacc::SmaccStateTable rebuiltTable;
+  smacc::buildStateTable<Container<0>>(rebuiltTable);
+  double cachedBuildTime = elapsedMicros(start);
+
+  // ---- instance ----
+  auto sharedTable = []() -> const smacc::SmaccStateTable& {
+    static const smacc::SmaccStateTable table = []() {
+      smacc::SmaccStateTable table;
+      smacc::buildStateTable<Container<0>>(table);
+      return table;
+    }();
+    return table;
+  };
+  sharedTable();
+
+  start = Clock::now();
+  for (int i = 0; i < instances; i++)
+  {
+    const smacc::SmaccStateTable& instanceTable = sharedTable();
+    asm volatile("" : : "r"(&instanceTable) : "memory");
+  }
+  double sharedInstanceTime = elapsedMicros(start) * 1000.0 / instances;
+
+  std::cout << "states: " << table.size() << " (checksum " << checksum + rebuiltTable.size() << ")" << std::endl;
+  std::cout << "---- names of all the states (us) ----" << std::endl;
+  std::cout << "  demangled: " << legacyNamesTime << " generated: " << generatedNamesTime << std::endl;
+  std::cout << "---- table build (us) ----" << std::endl;
+  std::cout << "  first: " << firstBuildTime << " names cached: " << cachedBuildTime << std::endl;
+  std::cout << "---- state table of a new state machine instance ----" << std::endl;
+  std::cout << "  rebuilt: " << cachedBuildTime << " us shared: " << sharedInstanceTime << " ns" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/state_table.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace smacc
+{
+// Active flags of the states of a state machine (one bit per StateId).
+// It is written only by the state machine thread and it can be read from any thread without locks.
+// Single flags are read with test(). snapshot() returns a consistent copy of all the flags (seqlock):
+// the version is odd while a flag is being changed.
+class ActiveStateSet
+{
+public:
+    ActiveStateSet()
+        : wordCount_(0), version_(0)
+    {
+    }
+
+    ActiveStateSet(const ActiveStateSet&) = delete;
+    ActiveStateSet& operator=(const ActiveStateSet&) = delete;
+
+    // it must be called before the state machine starts
+    void resize(int stateCount)
+    {
+        wordCount_ = (stateCount + 63) / 64;
+        words_.reset(new std::atomic<uint64_t>[wordCount_]);
+        for (int i = 0; i < wordCount_; i++)
+        {
+            words_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // returns true if the flag changed
+    bool set(StateId state, bool active)
+    {
+        auto& word = words_[state >> 6];
+        uint64_t mask = uint64_t(1) << (state & 63);
+        uint64_t current = word.load(std::memory_order_relaxed);
+        if (((current & mask) != 0) == active)
+            return false;
+
+        uint64_t version = version_.load(std::memory_order_relaxed);
+        version_.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        word.store(active ? current | mask : current & ~mask, std::memory_order_relaxed);
+
+        version_.store(version + 2, std::memory_order_release);
+        return true;
+    }
+
+    bool test(StateId state) const
+    {
+        return (words_[state >> 6].load(std::memory_order_acquire) >> (state & 63)) & 1;
+    }
+
+    // it changes each time a flag changes
+    uint64_t version() const
+    {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    // copies all the flags (bit i of words[i / 64] is the flag of the state i). Returns the version of the copy
+    uint64_t snapshot(std::vector<uint64_t>& words) const
+    {
+        words.resize(wordCount_);
+        for (;;)
+        {
+            uint64_t before = version_.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+
+            for (int i = 0; i < wordCount_; i++)
+            {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version_.load(std::memory_order_relaxed) == before)
+                return before;
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    int wordCount_;
+    std::atomic<uint64_t> version_;
+};
+}
@@ -0,0 +1,266 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/component_registry.h>
+#include <ros/ros.h>
+
+#include <boost/core/demangle.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace smacc
+{
+// Compile-time key of the blackboard. Usage:
+//     struct RadialStartPose : smacc::BlackboardKey<geometry_msgs::Pose> {};
+//     blackboard.set<RadialStartPose>(pose);
+template <typename T>
+struct BlackboardKey
+{
+    typedef T value_type;
+};
+
+class IBlackboardEntry
+{
+public:
+    virtual ~IBlackboardEntry()
+    {
+    }
+
+    virtual const std::type_info& getType() const = 0;
+};
+
+// Value of the blackboard with lock-free reads. It keeps two copies of the value (left-right / RCU):
+// the writer updates the copy that is not published and then publishes it, so that readers always
+// access a stable copy by reference. A writer only waits for the readers of the copy it is going to
+// overwrite (the ones that started before the previous write), so readers must not keep the reference.
+template <typename T>
+class BlackboardEntry : public IBlackboardEntry
+{
+public:
+    BlackboardEntry()
+        : version_(0)
+    {
+        readers_[0].store(0, std::memory_order_relaxed);
+        readers_[1].store(0, std::memory_order_relaxed);
+    }
+
+    virtual const std::type_info& getType() const override
+    {
+        return typeid(T);
+    }
+
+    bool hasValue() const
+    {
+        return version_.load(std::memory_order_acquire) != 0;
+    }
+
+    // calls f(const T&) with the current value (without copies). Returns false if it has no value
+    template <typename Function>
+    bool read(Function f) const
+    {
+        for (;;)
+        {
+            unsigned long version = version_.load();
+            if (version == 0)
+                return false;
+
+            ReaderGuard guard(readers_[version & 1]);
+
+            // the copy may have been overwritten before we were registered as readers
+            if (version_.load() != version)
+                continue;
+
+            f(values_[version & 1]);
+            return true;
+        }
+    }
+
+    // copies the current value. Returns false if it has no value
+    bool get(T& ret) const
+    {
+        return read([&](const T& value) { ret = value; });
+    }
+
+    void set(const T& value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        unsigned long next = version_.load(std::memory_order_relaxed) + 1;
+        waitReaders(next & 1);
+        values_[next & 1] = value;
+        version_.store(next);
+    }
+
+    void set(T&& value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        unsigned long next = version_.load(std::memory_order_relaxed) + 1;
+        waitReaders(next & 1);
+        values_[next & 1] = std::move(value);
+        version_.store(next);
+    }
+
+private:
+    struct ReaderGuard
+    {
+        ReaderGuard(std::atomic<int>& counter)
+            : counter_(counter)
+        {
+            counter_.fetch_add(1);
+        }
+
+        ~ReaderGuard()
+        {
+            counter_.fetch_sub(1, std::memory_order_release);
+        }
+
+        std::atomic<int>& counter_;
+    };
+
+    void waitReaders(int index)
+    {
+        while (readers_[index].load(std::memory_order_acquire) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    T values_[2];
+    std::atomic<unsigned long> version_;
+    mutable std::atomic<int> readers_[2];
+
+    // serializes the writers
+    std::mutex writeMutex_;
+};
+
+// Global data shared by the states of a state machine.
+//  - typed keys (BlackboardKey): the entry is found by a static type index and read without locks
+//  - string keys: compatibility layer of getGlobalSMData/setGlobalSMData. Finding the entry takes a
+//    short lock, reading its value does not.
+class Blackboard
+{
+public:
+    Blackboard()
+    {
+    }
+
+    Blackboard(const Blackboard&) = delete;
+    Blackboard& operator=(const Blackboard&) = delete;
+
+    template <typename Key>
+    void set(const typename Key::value_type& value)
+    {
+        getEntry<Key>()->set(value);
+    }
+
+    template <typename Key>
+    void set(typename Key::value_type&& value)
+    {
+        getEntry<Key>()->set(std::move(value));
+    }
+
+    // copies the value of the key. Returns false if it was never set
+    template <typename Key>
+    bool get(typename Key::value_type& ret) const
+    {
+        auto entry = entries_.template get<KeyEntry<Key>>();
+        return entry != nullptr && entry->get(ret);
+    }
+
+    // calls f(const value_type&) without copying the value. Returns false if it was never set
+    template <typename Key, typename Function>
+    bool read(Function f) const
+    {
+        auto entry = entries_.template get<KeyEntry<Key>>();
+        return entry != nullptr && entry->read(f);
+    }
+
+    template <typename Key>
+    bool has() const
+    {
+        auto entry = entries_.template get<KeyEntry<Key>>();
+        return entry != nullptr && entry->hasValue();
+    }
+
+    template <typename T>
+    void set(const std::string& name, const T& value)
+    {
+        // string literals are stored as const char*
+        getNamedEntry<typename std::decay<const T>::type>(name, true)->set(value);
+    }
+
+    template <typename T>
+    bool get(const std::string& name, T& ret)
+    {
+        auto entry = getNamedEntry<T>(name, false);
+        return entry != nullptr && entry->get(ret);
+    }
+
+private:
+    template <typename Key>
+    struct KeyEntry : BlackboardEntry<typename Key::value_type>
+    {
+    };
+
+    template <typename Key>
+    KeyEntry<Key>* getEntry()
+    {
+        return entries_.template getOrCreate<KeyEntry<Key>>([this]() {
+            auto entry = new KeyEntry<Key>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            ownedEntries_.emplace_back(entry);
+            return entry;
+        });
+    }
+
+    template <typename T>
+    BlackboardEntry<T>* getNamedEntry(const std::string& name, bool create)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = namedEntries_.find(name);
+        if (it != namedEntries_.end())
+        {
+            if (it->second->getType() == typeid(T))
+                return static_cast<BlackboardEntry<T>*>(it->second);
+
+            if (!create)
+            {
+                ROS_ERROR("[Blackboard] '%s' is a %s, not a %s", name.c_str(),
+                          boost::core::demangle(it->second->getType().name()).c_str(),
+                          boost::core::demangle(typeid(T).name()).c_str());
+                return nullptr;
+            }
+
+            // the value changes its type. The old entry is kept alive because it may be being read
+        }
+        else if (!create)
+        {
+            return nullptr;
+        }
+
+        auto entry = new BlackboardEntry<T>();
+        ownedEntries_.emplace_back(entry);
+        namedEntries_[name] = entry;
+        return entry;
+    }
+
+    TypeIndexedRegistry<IBlackboardEntry> entries_;
+
+    std::unordered_map<std::string, IBlackboardEntry*> namedEntries_;
+
+    std::vector<std::unique_ptr<IBlackboardEntry>> ownedEntries_;
+
+    std::mutex mutex_;
+};
+}
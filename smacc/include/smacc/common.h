@@ -26,67 +26,217 @@
 #include <boost/statechart/transition.hpp>
 #include <boost/any.hpp>
 #include <boost/algorithm/string.hpp>
+#include <smacc/lockfree_fifo_worker.h>
+#include <smacc/pool_allocator.h>
+#include <smacc/priority_scheduler.h>
+#include <smacc/trace.h>
 
 namespace sc = boost::statechart;
 
 using namespace boost;
 
-typedef sc::fifo_scheduler<> SmaccScheduler;
-
-typedef std::allocator< void > SmaccAllocator;
-
-
-template<class T>
-auto optionalNodeHandle(boost::intrusive_ptr<T>& obj)
- -> decltype(  obj->nh  )
+// pool allocator for the states, the events and the scheduler work items
+typedef smacc::SmaccPoolAllocator< void > SmaccAllocator;
+
+// define SMACC_LOCKFREE_SCHEDULER (cmake option of the smacc package) to replace the mutex-based
+// fifo_worker of the statechart scheduler by the lock-free ring buffer worker.
+// SMACC_PRIORITY_SCHEDULER (off by default) queues the events in priority lanes (see smacc::EventLane).
+// The lock-free worker has a single fifo: the lanes are ignored when both options are defined
+#if defined(SMACC_LOCKFREE_SCHEDULER)
+typedef sc::fifo_scheduler<smacc::LockFreeFifoWorker<>, SmaccAllocator> SmaccScheduler;
+#elif defined(SMACC_PRIORITY_SCHEDULER)
+typedef smacc::PriorityScheduler<SmaccAllocator> SmaccScheduler;
+#else
+typedef sc::fifo_scheduler<sc::fifo_worker<SmaccAllocator>, SmaccAllocator> SmaccScheduler;
+#endif
+
+
+// namespace of the inner states of a context relative to the state machine: the SmaccState contexts
+// have one ("StParent/"), the state machine and other contexts do not ("")
+template<class Context>
+auto contextRelativeNamespace(int) -> decltype(Context::getRelativeNamespace(), std::string())
 {
-    return obj->nh;
+    return Context::getRelativeNamespace() + "/";
 }
 
-template<class T>
-auto optionalNodeHandle(T* ) -> ros::NodeHandle
+template<class Context>
+std::string contextRelativeNamespace(long)
 {
-  return ros::NodeHandle("");
+    return std::string();
 }
 
-//typedef boost::fast_pool_allocator< int > MyAllocator;
-
 //template <typename MostDerived, typename Context, typename InnerList= mpl::list<>>
 //using SmaccState = sc::state<MostDerived,Context,InnerList>;
 
 
 //------------------------------------------------------------
 
-typedef boost::statechart::processor_container<boost::statechart::fifo_scheduler<>, boost::function0<void>, std::allocator<void> >::processor_context my_context;
+typedef SmaccScheduler::processor_context my_context;
 namespace smacc
 {
   class ISmaccStateMachine;
   class ISmaccComponent;
   class ISmaccActionClient;
+  class ISmaccTopicSubscriber;
   class SignalDetector;
 
+  // base class of the events that smacc creates from actionlib callbacks. It keeps the
+  // moment when the event was created to measure the latency until the state machine reacts
+  // and the moment when it was queued in the scheduler
+  struct ISmaccEvent
+  {
+    ISmaccEvent()
+      : postTime(ros::WallTime::now())
+    {
+    }
+
+    virtual ~ISmaccEvent()
+    {
+    }
+
+    // called from the state machine thread just before the event is dispatched to the states
+    virtual void onDispatch() const
+    {
+    }
+
+    // called just before the event is queued in the scheduler
+    void markQueued() const
+    {
+      queueTime = ros::WallTime::now();
+    }
+
+    // creation of the event
+    ros::WallTime postTime;
+
+    // when the event was queued in the scheduler (zero if it was queued without markQueued, ie: replay)
+    mutable ros::WallTime queueTime;
+  };
+
   struct IActionResult
   {
+    IActionResult()
+      : client(nullptr), resultState(actionlib::SimpleClientGoalState::LOST)
+    {
+    }
+
     smacc::ISmaccActionClient* client;
+
+    // final state of the goal, captured in the actionlib done callback
+    actionlib::SimpleClientGoalState resultState;
+
     actionlib::SimpleClientGoalState getResult() const;
   };
 
   template <typename ActionResult>
-  struct EvActionResult : sc::event< EvActionResult <ActionResult> >, IActionResult
-  { 
-      ActionResult resultMessage;
+  struct EvActionResult : sc::event< EvActionResult <ActionResult>, SmaccAllocator >, IActionResult, ISmaccEvent
+  {
+      // shared with actionlib (not copied). It may be null if the action server did not send any result
+      boost::shared_ptr<const ActionResult> resultMessage;
+
+      // by-value access of previous versions, where resultMessage was an ActionResult
+      // (ev.resultMessage.field -> ev.getResultMessage().field). An empty result if there is none
+      const ActionResult& getResultMessage() const
+      {
+          static const ActionResult empty;
+          return resultMessage ? *resultMessage : empty;
+      }
+  };
+
+  template <typename ActionFeedback>
+  struct EvActionFeedback : sc::event< EvActionFeedback <ActionFeedback>, SmaccAllocator >, ISmaccEvent
+  {
+      smacc::ISmaccActionClient* client;
+
+      // shared with actionlib (not copied)
+      boost::shared_ptr<const ActionFeedback> feedbackMessage;
+
+      // by-value access of previous versions, where feedbackMessage was an ActionFeedback
+      // (ev.feedbackMessage.field -> ev.getFeedbackMessage().field)
+      const ActionFeedback& getFeedbackMessage() const
+      {
+          static const ActionFeedback empty;
+          return feedbackMessage ? *feedbackMessage : empty;
+      }
+  };
+
+  // posted when a goal that was sent while the action server was not connected (see
+  // SmaccActionClientBase::sendGoal) has been sent to the server
+  template <typename ActionResult>
+  struct EvActionServerConnected : sc::event< EvActionServerConnected <ActionResult>, SmaccAllocator >, ISmaccEvent
+  {
+      smacc::ISmaccActionClient* client;
+
+      // time since sendGoal was called
+      ros::WallDuration waitTime;
+  };
+
+  // posted when the action server did not connect before the connection timeout. The goal is discarded
+  template <typename ActionResult>
+  struct EvActionServerTimeout : sc::event< EvActionServerTimeout <ActionResult>, SmaccAllocator >, ISmaccEvent
+  {
+      smacc::ISmaccActionClient* client;
+
+      ros::WallDuration waitTime;
   };
 
+  // opt-in alternative to EvActionFeedback (see SmaccActionClientBase::setFeedbackBatching). A single event
+  // carries all the feedback messages that were pending for the client, oldest first, so the state reacts
+  // once to N messages
   template <typename ActionFeedback>
-  struct EvActionFeedback : sc::event< EvActionFeedback <ActionFeedback>> 
+  struct EvActionFeedbackBatch : sc::event< EvActionFeedbackBatch <ActionFeedback>, SmaccAllocator >, ISmaccEvent
   {
       smacc::ISmaccActionClient* client;
-      ActionFeedback feedbackMessage;
-      //boost::any feedbackMessage;
+
+      // shared with actionlib (not copied)
+      std::vector<boost::shared_ptr<const ActionFeedback>> feedbackMessages;
+  };
+
+  // posted when the components declared by the states are connected (or their ready timeout expired),
+  // see ISmaccStateMachine::prewarmComponents
+  struct EvComponentsReady : sc::event< EvComponentsReady, SmaccAllocator >, ISmaccEvent
+  {
+      EvComponentsReady()
+        : notReady(0)
+      {
+      }
+
+      // components that were not ready when the timeout expired
+      int notReady;
+
+      // time since the state machine was initiated
+      ros::WallDuration waitTime;
+  };
+
+  // base of the EvTopicMessage events, it lets the subscriber know when its event is dispatched
+  // (latest-only coalescing, see SmaccTopicSubscriber)
+  struct ITopicMessageEvent : ISmaccEvent
+  {
+    ITopicMessageEvent()
+      : subscriber(nullptr)
+    {
+    }
+
+    virtual void onDispatch() const override;
+
+    smacc::ISmaccTopicSubscriber* subscriber;
+  };
+
+  // a message of the topic of a SmaccTopicSubscriber<MessageType> that passed its filters
+  template <typename MessageType>
+  struct EvTopicMessage : sc::event< EvTopicMessage <MessageType>, SmaccAllocator >, ITopicMessageEvent
+  {
+      // shared with roscpp (not copied)
+      boost::shared_ptr<const MessageType> message;
   };
 
   // demangles the type name to be used as a node handle path
   std::string cleanTypeName(const std::type_info& tinfo);
+
+  // offline mode (event replay): smacc does not use the ros master, the introspection is not
+  // published and the components are initialized with initOffline (see smacc::replay)
+  void setOfflineMode(bool offline);
+
+  bool isOfflineMode();
 }
 
 
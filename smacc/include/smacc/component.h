@@ -7,6 +7,9 @@
 
 #include <smacc/common.h>
 #include <smacc/smacc_state_machine.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
+#include <memory>
 
 namespace smacc
 {
@@ -20,15 +23,46 @@ public:
     // it is called just after the component is created by the State Machine
     virtual void init(ros::NodeHandle& nh);
 
+    // it is called instead of init in offline mode (event replay): the component must not connect
+    // with ros nor with other nodes. By default it does nothing
+    virtual void initOffline(ros::NodeHandle& nh);
+
+    // it is called at the state machine startup for the declared components (see ComponentDeclarations),
+    // from a thread of its own. It waits until the component is connected (ie: with its action server) or
+    // the timeout expires. Returns false if it is not ready
+    virtual bool waitUntilReady(ros::WallDuration timeout);
+
     // assings the owner of this resource to the given state machine parameter object 
     void setStateMachine(ISmaccStateMachine* stateMachine);
 
+    ISmaccStateMachine* getStateMachine() const;
+
     // returns a custom identifier defined by the specific plugin implementation
     virtual std::string getName() const;
 
+    // the callbacks of the subscriptions (and action clients) created with the given node handle are called
+    // from a spinner of this component (threads), instead of from the global callback queue that the signal
+    // detector spins. It is called by the state machine before init (see ~smacc_component_callback_threads)
+    void setDedicatedCallbackQueue(ros::NodeHandle& nh, int threads);
+
+    // starts the spinner of the dedicated callback queue (if any). It is called by the state machine after init
+    void startCallbackSpinner();
+
+    // null if the component uses the global callback queue
+    ros::CallbackQueue* getCallbackQueue() const;
+
+    // stops the callbacks of the component (the spinner of its dedicated callback queue, its subscriptions
+    // and timers). The state machine calls it when it is destroyed, while the derived members of the component
+    // still exist, so no callback can use them afterwards. The overrides must call the base one
+    virtual void shutdown();
+
 protected:
     // a reference to the state machine object that owns this resource
     ISmaccStateMachine* stateMachine_;
-    
+
+private:
+    // the spinner is destroyed (stopped) before the queue
+    std::unique_ptr<ros::CallbackQueue> callbackQueue_;
+    std::unique_ptr<ros::AsyncSpinner> callbackSpinner_;
 };
 }
\ No newline at end of file
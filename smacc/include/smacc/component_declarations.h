@@ -0,0 +1,71 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace smacc
+{
+class ISmaccStateMachine;
+class ISmaccComponent;
+
+// creates (or gets) the component in the state machine. ns: namespace of the node handle of the component
+typedef ISmaccComponent* (*ComponentFactory)(ISmaccStateMachine& stateMachine, const std::string& ns);
+
+struct ComponentDeclaration
+{
+    std::type_index type;
+    std::string ns;
+    ComponentFactory factory;
+};
+
+// Components that the states of a state machine require. The states list them in a static function that
+// is called when the state table is built, so that the state machine creates and connects all of them
+// at startup instead of on the first requiresComponent call:
+//
+//     static void declareComponents(smacc::ComponentDeclarations& components)
+//     {
+//         components.add<smacc::SmaccMoveBaseActionClient>("move_base");
+//         components.add<smacc_odom_tracker::OdomTracker>();
+//     }
+//
+// Only the first declaration of each component type is kept (the same rule than requiresComponent)
+class ComponentDeclarations
+{
+public:
+    // ns: the namespace of the node handle passed to requiresComponent ("": default node handle).
+    // It is defined in smacc_state_machine.h
+    template <typename ComponentType>
+    void add(const std::string& ns = "");
+
+    void add(const std::type_info& type, const std::string& ns, ComponentFactory factory)
+    {
+        for (auto& declaration : declarations_)
+        {
+            if (declaration.type == type)
+                return;
+        }
+
+        declarations_.push_back(ComponentDeclaration{ std::type_index(type), ns, factory });
+    }
+
+    const std::vector<ComponentDeclaration>& get() const
+    {
+        return declarations_;
+    }
+
+    bool empty() const
+    {
+        return declarations_.empty();
+    }
+
+private:
+    std::vector<ComponentDeclaration> declarations_;
+};
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace smacc
+{
+// Assigns a dense index (0, 1, 2, ...) to each type of a family the first time it is used
+template <typename Family>
+class TypeIndex
+{
+public:
+    template <typename T>
+    static std::size_t get()
+    {
+        static const std::size_t index = counter_.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+private:
+    static std::atomic<std::size_t> counter_;
+};
+
+template <typename Family>
+std::atomic<std::size_t> TypeIndex<Family>::counter_(0);
+
+// Stores one object of each type derived from Base, indexed by its TypeIndex.
+// Lookups are lock-free (two atomic loads). Only the creation of a new object takes a lock.
+// The slots are stored in chunks that are never reallocated nor released while the registry exists
+// (up to ChunkSize * MaxChunks types).
+template <typename Base, std::size_t ChunkSize = 64, std::size_t MaxChunks = 256>
+class TypeIndexedRegistry
+{
+public:
+    TypeIndexedRegistry()
+    {
+        for (auto& chunk : chunks_)
+        {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~TypeIndexedRegistry()
+    {
+        for (auto& chunk : chunks_)
+        {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    TypeIndexedRegistry(const TypeIndexedRegistry&) = delete;
+    TypeIndexedRegistry& operator=(const TypeIndexedRegistry&) = delete;
+
+    // returns nullptr if there is no object of this type
+    template <typename T>
+    T* get() const
+    {
+        std::size_t index = TypeIndex<Base>::template get<T>();
+        auto chunk = chunks_[index / ChunkSize].load(std::memory_order_acquire);
+        if (chunk == nullptr)
+            return nullptr;
+
+        return static_cast<T*>(chunk[index % ChunkSize].load(std::memory_order_acquire));
+    }
+
+    // returns the object of this type. If it does not exist it is created by the factory (only once)
+    template <typename T, typename Factory>
+    T* getOrCreate(Factory factory)
+    {
+        T* ret = get<T>();
+        if (ret != nullptr)
+            return ret;
+
+        // recursive: the factory may require other objects
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        ret = get<T>();
+        if (ret == nullptr)
+        {
+            ret = factory();
+            slot(TypeIndex<Base>::template get<T>()).store(static_cast<Base*>(ret), std::memory_order_release);
+        }
+
+        return ret;
+    }
+
+    // calls f(Base*) for each object. The objects created meanwhile may not be visited
+    template <typename Function>
+    void forEach(Function f) const
+    {
+        for (auto& chunk : chunks_)
+        {
+            auto slots = chunk.load(std::memory_order_acquire);
+            if (slots == nullptr)
+                continue;
+
+            for (std::size_t i = 0; i < ChunkSize; i++)
+            {
+                Base* object = slots[i].load(std::memory_order_acquire);
+                if (object != nullptr)
+                    f(object);
+            }
+        }
+    }
+
+private:
+    std::atomic<Base*>& slot(std::size_t index)
+    {
+        std::size_t chunkIndex = index / ChunkSize;
+        auto chunk = chunks_[chunkIndex].load(std::memory_order_acquire);
+        if (chunk == nullptr)
+        {
+            chunk = new std::atomic<Base*>[ChunkSize];
+            for (std::size_t i = 0; i < ChunkSize; i++)
+                chunk[i].store(nullptr, std::memory_order_relaxed);
+
+            chunks_[chunkIndex].store(chunk, std::memory_order_release);
+        }
+
+        return chunk[index % ChunkSize];
+    }
+
+    std::atomic<std::atomic<Base*>*> chunks_[MaxChunks];
+
+    std::recursive_mutex mutex_;
+};
+}
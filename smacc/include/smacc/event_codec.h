@@ -0,0 +1,266 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/common.h>
+#include <ros/serialization.h>
+
+#include <boost/core/demangle.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace smacc
+{
+typedef boost::intrusive_ptr<const sc::event_base> EventPtr;
+
+// Serializes the events of one type into the event log and creates them again on replay
+struct EventCodec
+{
+    // demangled name of the event type (it identifies the type in the log)
+    std::string name;
+
+    boost::function<void(const sc::event_base&, std::vector<uint8_t>&)> encode;
+
+    // returns null if the payload is not valid
+    boost::function<EventPtr(const uint8_t*, std::size_t)> decode;
+};
+
+// Codecs of the event types that can be recorded. The action clients register the codecs of their
+// EvActionResult, EvActionFeedback, EvActionFeedbackBatch and server connection events, custom events have to be registered by the user:
+//     smacc::registerEventCodec<EvToolReady>();
+class EventCodecRegistry
+{
+public:
+    static EventCodecRegistry& instance();
+
+    // only the first codec registered for a type is kept
+    void add(const std::type_info& type, const EventCodec& codec);
+
+    // they return nullptr if the type has no codec. The codecs are never removed
+    const EventCodec* find(const std::type_info& type) const;
+
+    const EventCodec* find(const std::string& name) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::type_index, std::unique_ptr<EventCodec>> byType_;
+    std::unordered_map<std::string, const EventCodec*> byName_;
+};
+
+// codec of an event type without data (it is default constructed on replay)
+template <typename EventType>
+void registerEventCodec()
+{
+    EventCodec codec;
+    codec.name = boost::core::demangle(typeid(EventType).name());
+    codec.encode = [](const sc::event_base&, std::vector<uint8_t>&) {};
+    codec.decode = [](const uint8_t*, std::size_t) -> EventPtr { return new EventType(); };
+    EventCodecRegistry::instance().add(typeid(EventType), codec);
+}
+
+// codec of an event type with data. decode returns nullptr if the payload is not valid
+template <typename EventType>
+void registerEventCodec(boost::function<void(const EventType&, std::vector<uint8_t>&)> encode,
+                        boost::function<boost::intrusive_ptr<EventType>(const uint8_t*, std::size_t)> decode)
+{
+    EventCodec codec;
+    codec.name = boost::core::demangle(typeid(EventType).name());
+    codec.encode = [encode](const sc::event_base& evt, std::vector<uint8_t>& buffer) {
+        encode(static_cast<const EventType&>(evt), buffer);
+    };
+    codec.decode = [decode](const uint8_t* data, std::size_t size) -> EventPtr { return decode(data, size); };
+    EventCodecRegistry::instance().add(typeid(EventType), codec);
+}
+
+namespace event_codec
+{
+// ros messages are stored with a presence flag (the shared pointers of actionlib may be null)
+template <typename Message>
+void writeMessage(const boost::shared_ptr<const Message>& message, std::vector<uint8_t>& buffer)
+{
+    buffer.push_back(message != nullptr);
+    if (message == nullptr)
+        return;
+
+    uint32_t length = ros::serialization::serializationLength(*message);
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + length);
+    ros::serialization::OStream stream(buffer.data() + offset, length);
+    ros::serialization::serialize(stream, *message);
+}
+
+// it throws ros::serialization::StreamOverrunException if the payload is truncated
+template <typename Message>
+void readMessage(const uint8_t*& data, const uint8_t* end, boost::shared_ptr<const Message>& message)
+{
+    if (data >= end)
+        throw ros::serialization::StreamOverrunException("missing message flag");
+
+    bool present = *data++;
+    if (!present)
+    {
+        message.reset();
+        return;
+    }
+
+    auto decoded = boost::make_shared<Message>();
+    ros::serialization::IStream stream(const_cast<uint8_t*>(data), end - data);
+    ros::serialization::deserialize(stream, *decoded);
+    data = stream.getData();
+    message = decoded;
+}
+
+template <typename T>
+void writeValue(const T& value, std::vector<uint8_t>& buffer)
+{
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(T));
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+void readValue(const uint8_t*& data, const uint8_t* end, T& value)
+{
+    if (end - data < (std::ptrdiff_t)sizeof(T))
+        throw ros::serialization::StreamOverrunException("truncated value");
+
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+}
+}
+
+// codec of EvActionServerConnected and EvActionServerTimeout (their wait time)
+template <typename EventType>
+void registerServerConnectionEventCodec()
+{
+    registerEventCodec<EventType>(
+        [](const EventType& ev, std::vector<uint8_t>& buffer) {
+            event_codec::writeValue((int64_t)ev.waitTime.toNSec(), buffer);
+        },
+        [](const uint8_t* data, std::size_t size) -> boost::intrusive_ptr<EventType> {
+            boost::intrusive_ptr<EventType> ev = new EventType();
+            ev->client = nullptr;
+            try
+            {
+                int64_t waitTime;
+                event_codec::readValue(data, data + size, waitTime);
+                ev->waitTime.fromNSec(waitTime);
+            }
+            catch (ros::serialization::StreamOverrunException&)
+            {
+                return nullptr;
+            }
+
+            return ev;
+        });
+}
+
+// codecs of the result and feedback events of an action. The client of the replayed events is null
+// (there is no action client connected to them)
+template <typename Result, typename Feedback>
+void registerActionEventCodecs()
+{
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        registerEventCodec<EvActionResult<Result>>(
+            [](const EvActionResult<Result>& ev, std::vector<uint8_t>& buffer) {
+                event_codec::writeValue((int32_t)ev.resultState.state_, buffer);
+                event_codec::writeValue((uint32_t)ev.resultState.text_.size(), buffer);
+                buffer.insert(buffer.end(), ev.resultState.text_.begin(), ev.resultState.text_.end());
+                event_codec::writeMessage(ev.resultMessage, buffer);
+            },
+            [](const uint8_t* data, std::size_t size) -> boost::intrusive_ptr<EvActionResult<Result>> {
+                const uint8_t* end = data + size;
+                boost::intrusive_ptr<EvActionResult<Result>> ev = new EvActionResult<Result>();
+                try
+                {
+                    int32_t state;
+                    uint32_t textLength;
+                    event_codec::readValue(data, end, state);
+                    event_codec::readValue(data, end, textLength);
+                    if ((std::size_t)(end - data) < textLength)
+                        return nullptr;
+
+                    std::string text((const char*)data, textLength);
+                    data += textLength;
+                    ev->resultState = actionlib::SimpleClientGoalState((actionlib::SimpleClientGoalState::StateEnum)state, text);
+                    event_codec::readMessage(data, end, ev->resultMessage);
+                }
+                catch (ros::serialization::StreamOverrunException&)
+                {
+                    return nullptr;
+                }
+
+                return ev;
+            });
+
+        registerEventCodec<EvActionFeedback<Feedback>>(
+            [](const EvActionFeedback<Feedback>& ev, std::vector<uint8_t>& buffer) {
+                event_codec::writeMessage(ev.feedbackMessage, buffer);
+            },
+            [](const uint8_t* data, std::size_t size) -> boost::intrusive_ptr<EvActionFeedback<Feedback>> {
+                boost::intrusive_ptr<EvActionFeedback<Feedback>> ev = new EvActionFeedback<Feedback>();
+                ev->client = nullptr;
+                try
+                {
+                    event_codec::readMessage(data, data + size, ev->feedbackMessage);
+                }
+                catch (ros::serialization::StreamOverrunException&)
+                {
+                    return nullptr;
+                }
+
+                return ev;
+            });
+
+        registerEventCodec<EvActionFeedbackBatch<Feedback>>(
+            [](const EvActionFeedbackBatch<Feedback>& ev, std::vector<uint8_t>& buffer) {
+                event_codec::writeValue((uint32_t)ev.feedbackMessages.size(), buffer);
+                for (auto& message : ev.feedbackMessages)
+                {
+                    event_codec::writeMessage(message, buffer);
+                }
+            },
+            [](const uint8_t* data, std::size_t size) -> boost::intrusive_ptr<EvActionFeedbackBatch<Feedback>> {
+                const uint8_t* end = data + size;
+                boost::intrusive_ptr<EvActionFeedbackBatch<Feedback>> ev = new EvActionFeedbackBatch<Feedback>();
+                ev->client = nullptr;
+                try
+                {
+                    uint32_t count;
+                    event_codec::readValue(data, end, count);
+
+                    // each message takes at least its presence flag
+                    if ((std::size_t)(end - data) < count)
+                        return nullptr;
+
+                    ev->feedbackMessages.resize(count);
+                    for (auto& message : ev->feedbackMessages)
+                    {
+                        event_codec::readMessage(data, end, message);
+                    }
+                }
+                catch (ros::serialization::StreamOverrunException&)
+                {
+                    return nullptr;
+                }
+
+                return ev;
+            });
+
+        registerServerConnectionEventCodec<EvActionServerConnected<Result>>();
+        registerServerConnectionEventCodec<EvActionServerTimeout<Result>>();
+    });
+}
+}
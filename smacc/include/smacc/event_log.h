@@ -0,0 +1,160 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/event_codec.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace smacc
+{
+namespace event_log
+{
+// file format: FileHeader followed by records (RecordHeader + payload) until a record of kind END
+// or the end of the file. The file is written through a memory map, so a crashed process leaves
+// a readable log whose tail is filled with zeros (END records).
+//  - TYPE record payload: uint32 type id, type name
+//  - EVENT record payload: EventHeader, encoded event
+const char FILE_MAGIC[8] = { 'S', 'M', 'A', 'C', 'C', 'E', 'V', 'L' };
+const uint32_t FILE_VERSION = 1;
+
+enum RecordKind : uint32_t
+{
+    END = 0,
+    TYPE = 1,
+    EVENT = 2
+};
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+
+    // wall time (nanoseconds) when the log was created
+    uint64_t startTime;
+};
+
+struct RecordHeader
+{
+    uint32_t kind;
+    uint32_t size;
+};
+
+struct EventHeader
+{
+    // wall time (nanoseconds) when the event was created (smacc events) and when it was dispatched
+    uint64_t postTime;
+    uint64_t dispatchTime;
+    uint32_t type;
+
+    // 1 if the event type had no codec when it was recorded (the payload is empty)
+    uint32_t noCodec;
+};
+}
+
+// Append-only log of the events dispatched by one state machine. It is only written from the
+// state machine thread. The file grows in chunks and it is mapped in memory, so appending an event
+// is a memcpy into the page cache.
+class EventLogWriter
+{
+public:
+    EventLogWriter();
+
+    ~EventLogWriter();
+
+    EventLogWriter(const EventLogWriter&) = delete;
+    EventLogWriter& operator=(const EventLogWriter&) = delete;
+
+    // returns false if the file could not be created
+    bool open(const std::string& path);
+
+    // truncates the file to the written size
+    void close();
+
+    bool isOpen() const;
+
+    void append(const sc::event_base& evt, uint64_t postTime, uint64_t dispatchTime);
+
+    uint64_t getEventCount() const;
+
+    const std::string& getPath() const;
+
+private:
+    // id of the type in this log. The TYPE record is written the first time the type is seen
+    uint32_t typeId(const sc::event_base& evt, const EventCodec*& codec);
+
+    void write(uint32_t kind, const void* payload1, uint32_t size1, const void* payload2, uint32_t size2);
+
+    bool reserve(std::size_t bytes);
+
+    std::string path_;
+    int fd_;
+    uint8_t* data_;
+    std::size_t capacity_;
+    std::size_t size_;
+    uint64_t eventCount_;
+
+    struct LoggedType
+    {
+        uint32_t id;
+        const EventCodec* codec;
+    };
+
+    std::unordered_map<std::type_index, LoggedType> types_;
+
+    // reused encoding buffer
+    std::vector<uint8_t> buffer_;
+};
+
+// Sequential reader of an event log (memory mapped)
+class EventLogReader
+{
+public:
+    struct Event
+    {
+        event_log::EventHeader header;
+
+        // name of the event type (null if the log does not define it)
+        const std::string* type;
+
+        const uint8_t* payload;
+        std::size_t size;
+    };
+
+    EventLogReader();
+
+    ~EventLogReader();
+
+    EventLogReader(const EventLogReader&) = delete;
+    EventLogReader& operator=(const EventLogReader&) = delete;
+
+    // returns false if the file could not be read or it is not an event log
+    bool open(const std::string& path);
+
+    void close();
+
+    // returns false at the end of the log. The event is valid until the reader is closed
+    bool next(Event& event);
+
+    const event_log::FileHeader& getHeader() const;
+
+private:
+    int fd_;
+    const uint8_t* data_;
+    std::size_t size_;
+    std::size_t offset_;
+    event_log::FileHeader header_;
+
+    // type names indexed by type id (a deque, so that the names referenced by the events do not move)
+    std::deque<std::string> types_;
+};
+}
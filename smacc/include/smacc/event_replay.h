@@ -0,0 +1,122 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/common.h>
+#include <smacc/event_log.h>
+#include <smacc/signal_detector.h>
+#include <ros/master.h>
+
+#include <sstream>
+#include <string>
+
+namespace smacc
+{
+struct ReplayOptions
+{
+    ReplayOptions()
+        : speed(0)
+    {
+    }
+
+    // 0: as fast as possible. Otherwise the recorded intervals between events are divided by speed
+    double speed;
+};
+
+struct ReplayStats
+{
+    ReplayStats();
+
+    // events of the log
+    uint64_t events;
+
+    // events injected into the state machine
+    uint64_t replayed;
+
+    // events without codec or with an invalid payload
+    uint64_t skipped;
+
+    // from the first to the last recorded event
+    double recordedSeconds;
+
+    double replaySeconds;
+
+    void toString(std::stringstream& ss) const;
+};
+
+// reads the events of a log and creates them again with their codecs (non template part of smacc::replay)
+class EventReplayer
+{
+public:
+    EventReplayer();
+
+    bool open(const std::string& path, const ReplayOptions& options);
+
+    // returns false at the end of the log. The skipped events are not returned
+    bool next(EventPtr& event);
+
+    // it has to be called when the last event has been processed
+    void finish();
+
+    const ReplayStats& getStats() const;
+
+private:
+    // paces the events when options.speed > 0
+    void wait(uint64_t dispatchTime);
+
+    EventLogReader reader_;
+    ReplayOptions options_;
+    ReplayStats stats_;
+
+    ros::WallTime start_;
+    uint64_t firstDispatchTime_;
+    uint64_t lastDispatchTime_;
+};
+
+// Replays an event log recorded with ~smacc_event_log_file into a new instance of the state machine,
+// without action servers nor roscore (offline mode). ros::init has to be called first.
+// Each event is dispatched before the next one is injected, so the replay is deterministic.
+//
+// usage:
+//     ros::init(argc, argv, "radial_motion_replay", ros::init_options::NoRosout);
+//     auto stats = smacc::replay<RadialMotionStateMachine>("/tmp/radial_motion.evl");
+template <typename StateMachineType>
+ReplayStats replay(const std::string& path, const ReplayOptions& options = ReplayOptions())
+{
+    setOfflineMode(true);
+
+    // the master calls that roscpp does by itself (ros::start) fail at once when there is no roscore
+    ros::master::setRetryTimeout(ros::WallDuration(0.01));
+
+    EventReplayer replayer;
+    if (!replayer.open(path, options))
+    {
+        ROS_ERROR_STREAM("[replay] " << path << " is not a smacc event log");
+        return replayer.getStats();
+    }
+
+    // non blocking scheduler: it is executed in this thread until its queue is empty
+    SmaccScheduler scheduler(false);
+    SignalDetector signalDetector;
+
+    SmaccScheduler::processor_handle handle = scheduler.create_processor<StateMachineType>(&signalDetector);
+    scheduler.initiate_processor(handle);
+    scheduler(0);
+
+    EventPtr event;
+    while (replayer.next(event))
+    {
+        scheduler.queue_event(handle, event);
+        scheduler(0);
+    }
+
+    scheduler.destroy_processor(handle);
+    scheduler(0);
+
+    replayer.finish();
+    return replayer.getStats();
+}
+}
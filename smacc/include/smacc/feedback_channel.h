@@ -0,0 +1,252 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace smacc
+{
+// How the feedback messages of an action client are delivered to the state machine
+enum class FeedbackPolicy
+{
+    // every message is delivered (while the channel is not full)
+    DELIVER_ALL,
+
+    // only the newest message is delivered, older pending messages are coalesced
+    LATEST_ONLY,
+
+    // one of every N messages is delivered
+    DECIMATE
+};
+
+// What happens when a message arrives and the ring of the channel is full (DELIVER_ALL and DECIMATE)
+enum class FeedbackOverflowPolicy
+{
+    // the oldest pending message is discarded (default, as the feedback queue of previous versions)
+    DROP_OLDEST,
+
+    // the new message is discarded
+    DROP_NEWEST
+};
+
+// Lock-free single producer (the actionlib feedback callback) / single consumer (the signal detector)
+// channel of feedback messages. It stores the shared pointers of actionlib, so that the messages are never copied.
+//  - DELIVER_ALL and DECIMATE use a bounded ring. When it is full the oldest message is dropped (see
+//    FeedbackOverflowPolicy): the producer takes it out of the ring as a second consumer, so the slots have
+//    sequence numbers (bounded queue of D. Vyukov) and the consumer never reads a slot that is being written.
+//  - LATEST_ONLY uses a triple buffer, so that the producer never blocks nor drops the newest message.
+template <typename Message>
+class FeedbackChannel
+{
+public:
+    typedef boost::shared_ptr<const Message> MessageConstPtr;
+
+    FeedbackChannel(std::size_t capacity = 16)
+        : head_(0), tail_(0), middle_(1), back_(0), front_(2),
+          policy_(FeedbackPolicy::DELIVER_ALL), overflowPolicy_(FeedbackOverflowPolicy::DROP_OLDEST), decimation_(1),
+          decimationCounter_(0), received_(0), dropped_(0), coalesced_(0)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        ring_.reset(new Slot[size]);
+        for (std::size_t i = 0; i < size; i++)
+            ring_[i].sequence.store(i, std::memory_order_relaxed);
+
+        mask_ = size - 1;
+    }
+
+    // it has to be called before the first message is pushed (i.e. before sending the goal)
+    void setPolicy(FeedbackPolicy policy, unsigned int decimation = 1)
+    {
+        policy_ = policy;
+        decimation_ = decimation > 0 ? decimation : 1;
+        decimationCounter_ = 0;
+    }
+
+    FeedbackPolicy getPolicy() const
+    {
+        return policy_;
+    }
+
+    // it has to be called before the first message is pushed
+    void setOverflowPolicy(FeedbackOverflowPolicy overflowPolicy)
+    {
+        overflowPolicy_ = overflowPolicy;
+    }
+
+    FeedbackOverflowPolicy getOverflowPolicy() const
+    {
+        return overflowPolicy_;
+    }
+
+    // producer side
+    void push(const MessageConstPtr& message)
+    {
+        received_.fetch_add(1, std::memory_order_relaxed);
+
+        if (policy_ == FeedbackPolicy::LATEST_ONLY)
+        {
+            latest_[back_] = message;
+            int previous = middle_.exchange(back_ | DIRTY, std::memory_order_acq_rel);
+            if (previous & DIRTY)
+            {
+                // the consumer did not take the previous message
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+            }
+            back_ = previous & INDEX_MASK;
+            return;
+        }
+
+        if (policy_ == FeedbackPolicy::DECIMATE && (decimationCounter_++ % decimation_) != 0)
+        {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        Slot& slot = ring_[tail & mask_];
+        while (slot.sequence.load(std::memory_order_acquire) != tail)
+        {
+            // the slot still holds the message tail - size: the ring is full or the consumer is taking it
+            if (overflowPolicy_ == FeedbackOverflowPolicy::DROP_NEWEST)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // if the consumer already claimed the oldest message the slot is released in a moment
+            MessageConstPtr oldest;
+            if (tail - head_.load(std::memory_order_acquire) > mask_ && tryPop(oldest))
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        slot.message = message;
+        slot.sequence.store(tail + 1, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    // consumer side. Returns false if there is no pending message
+    bool pop(MessageConstPtr& message)
+    {
+        if (policy_ == FeedbackPolicy::LATEST_ONLY)
+        {
+            if (!(middle_.load(std::memory_order_acquire) & DIRTY))
+                return false;
+
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+            message = latest_[front_];
+            latest_[front_].reset();
+            return true;
+        }
+
+        return tryPop(message);
+    }
+
+    bool empty() const
+    {
+        if (policy_ == FeedbackPolicy::LATEST_ONLY)
+            return !(middle_.load(std::memory_order_acquire) & DIRTY);
+
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // max number of pending messages (one with LATEST_ONLY)
+    std::size_t capacity() const
+    {
+        return policy_ == FeedbackPolicy::LATEST_ONLY ? 1 : mask_ + 1;
+    }
+
+    // number of messages received from the action server
+    unsigned long getReceivedCount() const
+    {
+        return received_.load(std::memory_order_relaxed);
+    }
+
+    // number of messages lost because the channel was full (the oldest or the new ones, see FeedbackOverflowPolicy)
+    unsigned long getDroppedCount() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // number of messages discarded by the policy (replaced by a newer one or decimated)
+    unsigned long getCoalescedCount() const
+    {
+        return coalesced_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const int DIRTY = 4;
+    static const int INDEX_MASK = 3;
+
+    // sequence: position + 1 when the slot holds the message of that position, position when it can be
+    // written at that position
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        MessageConstPtr message;
+    };
+
+    // ring consumer side: the consumer and the producer (DROP_OLDEST) claim the oldest message moving head_
+    bool tryPop(MessageConstPtr& message)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = ring_[head & mask_];
+            std::ptrdiff_t diff = (std::ptrdiff_t)slot.sequence.load(std::memory_order_acquire) - (std::ptrdiff_t)(head + 1);
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    message = std::move(slot.message);
+                    slot.message.reset();
+                    slot.sequence.store(head + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // empty
+                return false;
+            }
+            else
+            {
+                head = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // ring (DELIVER_ALL, DECIMATE)
+    std::unique_ptr<Slot[]> ring_;
+    std::size_t mask_;
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+
+    // triple buffer (LATEST_ONLY): the producer owns back_, the consumer owns front_
+    // and middle_ is exchanged between them (with a flag that says if it has a new message)
+    MessageConstPtr latest_[3];
+    std::atomic<int> middle_;
+    int back_;
+    int front_;
+
+    FeedbackPolicy policy_;
+    FeedbackOverflowPolicy overflowPolicy_;
+    unsigned int decimation_;
+    unsigned long decimationCounter_;
+
+    std::atomic<unsigned long> received_;
+    std::atomic<unsigned long> dropped_;
+    std::atomic<unsigned long> coalesced_;
+};
+}
@@ -0,0 +1,328 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <actionlib/action_definition.h>
+#include <actionlib/client/simple_client_goal_state.h>
+#include <ros/names.h>
+#include <ros/console.h>
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace smacc
+{
+// Action server for the clients that live in the same process (ie: the server is loaded as a nodelet or
+// created by the state machine node). The goals, feedback and results are passed as shared pointers,
+// without serialization nor TCPROS. The SmaccActionClientBase<ActionType> clients whose action name
+// matches a started server use it, and they use actionlib otherwise.
+//
+// Its interface is the subset of actionlib::SimpleActionServer used by the execute callback servers:
+//
+//     IntraProcessActionServer<ToolControlAction> server("tool_action_server",
+//         [&](const ToolControlGoalConstPtr& goal) {
+//             while(!server.isPreemptRequested()) { ... server.publishFeedback(feedback); }
+//             server.setPreempted();
+//         }, true);
+//
+// The execute callback is called from a thread of the server, one goal at a time. A new goal preempts the
+// active one (isPreemptRequested) and it is executed when the execute callback returns.
+template <typename ActionType>
+class IntraProcessActionServer
+{
+public:
+    ACTION_DEFINITION(ActionType);
+
+    typedef boost::function<void(const GoalConstPtr&)> ExecuteCallback;
+    typedef boost::function<void(const FeedbackConstPtr&)> FeedbackCallback;
+    typedef boost::function<void(const actionlib::SimpleClientGoalState&, const ResultConstPtr&)> DoneCallback;
+
+    // name: action name, resolved as a ros name (ie: "tool_action_server" -> "/tool_action_server")
+    IntraProcessActionServer(const std::string& name, const ExecuteCallback& execute, bool autoStart)
+        : name_(ros::names::resolve(name)), execute_(execute), started_(false), shutdown_(false),
+          active_(false), preemptRequested_(false)
+    {
+        if(autoStart)
+            start();
+    }
+
+    virtual ~IntraProcessActionServer()
+    {
+        shutdown();
+    }
+
+    // the clients see the server from now on
+    void start()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(started_)
+                return;
+            started_ = true;
+        }
+
+        executeThread_ = boost::thread(boost::bind(&IntraProcessActionServer<ActionType>::executeLoop, this));
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& server = registry()[name_];
+        if(server != nullptr)
+            ROS_WARN("Intra-process action server %s already exists, it is replaced", name_.c_str());
+        server = this;
+    }
+
+    // the pending goal is preempted, the active one is preempted when the execute callback returns
+    void shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto it = registry().find(name_);
+            if(it != registry().end() && it->second == this)
+                registry().erase(it);
+        }
+
+        std::shared_ptr<Session> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+            preemptRequested_ = true;
+            next = std::move(next_);
+        }
+        goalCondition_.notify_all();
+
+        if(next)
+            next->done(actionlib::SimpleClientGoalState::PREEMPTED, boost::make_shared<const Result>());
+
+        if(executeThread_.joinable())
+            executeThread_.join();
+    }
+
+    const std::string& getName() const
+    {
+        return name_;
+    }
+
+    // ---------------- execute callback side ----------------
+
+    bool isActive()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_;
+    }
+
+    bool isPreemptRequested()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return preemptRequested_;
+    }
+
+    bool isNewGoalAvailable()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return next_ != nullptr;
+    }
+
+    void publishFeedback(const Feedback& feedback)
+    {
+        publishFeedback(boost::make_shared<const Feedback>(feedback));
+    }
+
+    // the message is shared with the client, it must not be modified after this call
+    void publishFeedback(const FeedbackConstPtr& feedback)
+    {
+        std::shared_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(!active_)
+                return;
+            session = current_;
+        }
+
+        if(session->feedback)
+            session->feedback(feedback);
+    }
+
+    void setSucceeded(const Result& result = Result())
+    {
+        finish(actionlib::SimpleClientGoalState::SUCCEEDED, boost::make_shared<const Result>(result));
+    }
+
+    void setSucceeded(const ResultConstPtr& result)
+    {
+        finish(actionlib::SimpleClientGoalState::SUCCEEDED, result);
+    }
+
+    void setAborted(const Result& result = Result())
+    {
+        finish(actionlib::SimpleClientGoalState::ABORTED, boost::make_shared<const Result>(result));
+    }
+
+    void setPreempted(const Result& result = Result())
+    {
+        finish(actionlib::SimpleClientGoalState::PREEMPTED, boost::make_shared<const Result>(result));
+    }
+
+    // ---------------- client side ----------------
+
+    // true if a server with this action name is started in this process
+    static bool exists(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        return registry().count(name) > 0;
+    }
+
+    // sends the goal to the server with this action name. Returns false if there is no such server.
+    // The callbacks are called from the execute thread of the server
+    static bool sendGoal(const std::string& name, const GoalConstPtr& goal, const FeedbackCallback& feedback,
+                         const DoneCallback& done)
+    {
+        // the registry lock keeps the server alive while the goal is queued
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(name);
+        if(it == registry().end())
+            return false;
+
+        it->second->queueGoal(goal, feedback, done);
+        return true;
+    }
+
+    // preempts the active and the pending goal of the server with this action name
+    static bool cancelGoal(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(name);
+        if(it == registry().end())
+            return false;
+
+        it->second->cancel();
+        return true;
+    }
+
+private:
+    struct Session
+    {
+        GoalConstPtr goal;
+        FeedbackCallback feedback;
+        DoneCallback done;
+    };
+
+    void queueGoal(const GoalConstPtr& goal, const FeedbackCallback& feedback, const DoneCallback& done)
+    {
+        auto session = std::make_shared<Session>();
+        session->goal = goal;
+        session->feedback = feedback;
+        session->done = done;
+
+        std::shared_ptr<Session> replaced;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(active_)
+                preemptRequested_ = true;
+
+            replaced = std::move(next_);
+            next_ = session;
+        }
+        goalCondition_.notify_one();
+
+        if(replaced)
+            replaced->done(actionlib::SimpleClientGoalState::PREEMPTED, boost::make_shared<const Result>());
+    }
+
+    void cancel()
+    {
+        std::shared_ptr<Session> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(active_)
+                preemptRequested_ = true;
+
+            next = std::move(next_);
+        }
+
+        if(next)
+            next->done(actionlib::SimpleClientGoalState::PREEMPTED, boost::make_shared<const Result>());
+    }
+
+    void finish(const actionlib::SimpleClientGoalState& state, const ResultConstPtr& result)
+    {
+        std::shared_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(!active_)
+                return;
+
+            active_ = false;
+            session = std::move(current_);
+        }
+
+        session->done(state, result);
+    }
+
+    void executeLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(!shutdown_)
+        {
+            if(!next_)
+            {
+                goalCondition_.wait(lock);
+                continue;
+            }
+
+            current_ = std::move(next_);
+            active_ = true;
+            preemptRequested_ = false;
+            GoalConstPtr goal = current_->goal;
+
+            lock.unlock();
+            execute_(goal);
+            lock.lock();
+
+            if(active_)
+            {
+                ROS_WARN("Intra-process action server %s: the execute callback returned without setting the goal "
+                         "state, the goal is aborted", name_.c_str());
+                lock.unlock();
+                setAborted();
+                lock.lock();
+            }
+        }
+    }
+
+    static std::mutex& registryMutex()
+    {
+        static std::mutex instance;
+        return instance;
+    }
+
+    // started servers of ActionType by action name
+    static std::map<std::string, IntraProcessActionServer<ActionType>*>& registry()
+    {
+        static std::map<std::string, IntraProcessActionServer<ActionType>*> instance;
+        return instance;
+    }
+
+    std::string name_;
+    ExecuteCallback execute_;
+
+    std::mutex mutex_;
+    std::condition_variable goalCondition_;
+    bool started_;
+    bool shutdown_;
+    bool active_;
+    bool preemptRequested_;
+
+    std::shared_ptr<Session> current_;
+    std::shared_ptr<Session> next_;
+
+    boost::thread executeThread_;
+};
+}
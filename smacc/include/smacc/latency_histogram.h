@@ -0,0 +1,66 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+
+namespace smacc
+{
+// Lock-free histogram of latencies (nanoseconds) with HDR-style buckets: each power of two range is
+// split into 8 linear sub-buckets, so the relative error of the percentiles is below 12.5%.
+// It can be written from several threads and read from any other thread without locks.
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    // it covers up to 2^48 nanoseconds (~3 days). Longer samples are stored in the last bucket
+    static const int MAX_MAGNITUDE = 48;
+    static const int BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    // adds a new latency sample
+    void record(int64_t nanoseconds);
+
+    // removes all the samples
+    void reset();
+
+    // accumulates the samples of other histogram into this one
+    void add(const LatencyHistogram& other);
+
+    uint64_t count() const;
+
+    // mean latency in nanoseconds
+    double mean() const;
+
+    uint64_t max() const;
+
+    // upper bound (nanoseconds) of the bucket where the given percentile [0,1] is located
+    uint64_t percentile(double p) const;
+
+    uint64_t bucketCount(int bucketIndex) const;
+
+    // range of the samples of the bucket: [lowerBound, upperBound) nanoseconds
+    static uint64_t bucketLowerBound(int bucketIndex);
+
+    static uint64_t bucketUpperBound(int bucketIndex);
+
+    static int bucketIndex(uint64_t nanoseconds);
+
+    // prints the current state of the histogram into a string
+    void toString(std::stringstream& ss) const;
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+}
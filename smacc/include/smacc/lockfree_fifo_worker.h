@@ -0,0 +1,291 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace smacc
+{
+// Drop-in replacement of boost::statechart::fifo_worker<> to be used as the FifoWorker template
+// parameter of sc::fifo_scheduler. The work items are stored in a bounded multi-producer/single-consumer
+// ring buffer (no mutex on queue_work_item) and the worker thread waits with an adaptive strategy:
+// it spins, then yields and finally parks on a condition variable that producers only notify when needed.
+//
+// Capacity must be a power of two. When the ring is full the producers of other threads wait until the worker
+// thread frees a slot. The worker thread itself (and every producer if there is no dedicated worker thread,
+// waitOnEmptyQueue = false) cannot wait for it: their items go to an unbounded overflow queue (with a mutex)
+// until the worker drains it, as the PriorityScheduler lanes grow in that case.
+template <std::size_t Capacity = 4096, unsigned SpinIterations = 4000, unsigned YieldIterations = 100>
+class LockFreeFifoWorker : boost::noncopyable
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "LockFreeFifoWorker capacity must be a power of two");
+
+public:
+    typedef boost::function0<void> work_item;
+
+    LockFreeFifoWorker(bool waitOnEmptyQueue = false)
+        : waitOnEmptyQueue_(waitOnEmptyQueue), terminated_(false), enqueuePos_(0), dequeuePos_(0), overflowCount_(0),
+          overflowTotal_(0), parked_(false), parkCount_(0)
+    {
+        for (std::size_t i = 0; i < Capacity; i++)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // We take a non-const reference so that we can swap the item into the ring buffer
+    // (same semantic than fifo_worker)
+    void queue_work_item(work_item& item)
+    {
+        if (item.empty())
+        {
+            return;
+        }
+
+        // the items queued after the overflowed ones must not overtake them
+        if (overflowCount_.load(std::memory_order_acquire) > 0)
+        {
+            queue_overflow_item(item);
+            return;
+        }
+
+        std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;)
+        {
+            slot = &slots_[pos & (Capacity - 1)];
+            std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                // the ring is full: wait for the worker thread, unless it is the current thread (or there is no
+                // dedicated worker thread) because nobody would free the slot
+                if (!waitOnEmptyQueue_ || std::this_thread::get_id() == workerThread_.load(std::memory_order_relaxed))
+                {
+                    queue_overflow_item(item);
+                    return;
+                }
+
+                std::this_thread::yield();
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->item.swap(item);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        wake_up();
+    }
+
+    void queue_work_item(const work_item& item)
+    {
+        work_item copy = item;
+        queue_work_item(copy);
+    }
+
+    void terminate()
+    {
+        work_item item = boost::bind(&LockFreeFifoWorker::terminate_impl, this);
+        queue_work_item(item);
+    }
+
+    // Must only be called from the thread that also calls operator()
+    bool terminated() const
+    {
+        return terminated_;
+    }
+
+    // number of times the worker thread had to sleep on the condition variable
+    unsigned long parkCount() const
+    {
+        return parkCount_.load(std::memory_order_relaxed);
+    }
+
+    // number of items that were queued in the overflow queue because the ring was full
+    unsigned long overflowCount() const
+    {
+        return overflowTotal_.load(std::memory_order_relaxed);
+    }
+
+    unsigned long operator()(unsigned long maxItemCount = 0)
+    {
+        workerThread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        unsigned long itemCount = 0;
+
+        while (!terminated() && ((maxItemCount == 0) || (itemCount < maxItemCount)))
+        {
+            work_item item = dequeue_item();
+
+            if (item.empty())
+            {
+                return itemCount;
+            }
+
+            item();
+            ++itemCount;
+        }
+
+        return itemCount;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        work_item item;
+    };
+
+    bool empty() const
+    {
+        const Slot& slot = slots_[dequeuePos_ & (Capacity - 1)];
+        return slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1;
+    }
+
+    bool try_dequeue(work_item& result)
+    {
+        if (empty())
+            return try_dequeue_overflow(result);
+
+        Slot& slot = slots_[dequeuePos_ & (Capacity - 1)];
+        result.swap(slot.item);
+        slot.sequence.store(dequeuePos_ + Capacity, std::memory_order_release);
+        dequeuePos_++;
+        return true;
+    }
+
+    void queue_overflow_item(work_item& item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(overflowMutex_);
+            overflow_.emplace_back();
+            overflow_.back().swap(item);
+            overflowCount_.fetch_add(1, std::memory_order_release);
+        }
+
+        overflowTotal_.fetch_add(1, std::memory_order_relaxed);
+        wake_up();
+    }
+
+    // the overflowed items are dequeued once the ring is empty (they were queued after the items of the ring)
+    bool try_dequeue_overflow(work_item& result)
+    {
+        if (overflowCount_.load(std::memory_order_acquire) == 0)
+            return false;
+
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        result.swap(overflow_.front());
+        overflow_.pop_front();
+        overflowCount_.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    bool has_work() const
+    {
+        return !empty() || overflowCount_.load(std::memory_order_acquire) > 0;
+    }
+
+    // wakes up the worker thread only if it is parked
+    void wake_up()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(parkMutex_);
+            parkCondition_.notify_one();
+        }
+    }
+
+    work_item dequeue_item()
+    {
+        work_item result;
+        for (unsigned iteration = 0;; iteration++)
+        {
+            if (try_dequeue(result) || !waitOnEmptyQueue_)
+            {
+                return result;
+            }
+
+            if (iteration < SpinIterations)
+            {
+                continue;
+            }
+            else if (iteration < SpinIterations + YieldIterations)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                park();
+                iteration = 0;
+            }
+        }
+    }
+
+    void park()
+    {
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!has_work())
+        {
+            parkCount_.fetch_add(1, std::memory_order_relaxed);
+            while (!has_work())
+            {
+                parkCondition_.wait(lock);
+            }
+        }
+
+        parked_.store(false, std::memory_order_relaxed);
+    }
+
+    void terminate_impl()
+    {
+        terminated_ = true;
+    }
+
+    const bool waitOnEmptyQueue_;
+    bool terminated_;
+
+    Slot slots_[Capacity];
+
+    // producers position and consumer position are kept in different cache lines
+    alignas(64) std::atomic<std::size_t> enqueuePos_;
+    alignas(64) std::size_t dequeuePos_;
+
+    // thread that runs operator() (the last one, if there is no dedicated worker thread)
+    std::atomic<std::thread::id> workerThread_;
+
+    // items queued while the ring was full, in fifo order
+    std::deque<work_item> overflow_;
+    std::mutex overflowMutex_;
+    std::atomic<std::size_t> overflowCount_;
+    std::atomic<unsigned long> overflowTotal_;
+
+    alignas(64) std::atomic<bool> parked_;
+    std::atomic<unsigned long> parkCount_;
+    std::mutex parkMutex_;
+    std::condition_variable parkCondition_;
+};
+}
@@ -0,0 +1,175 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <boost/pool/pool.hpp>
+#include <boost/pool/singleton_pool.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sstream>
+
+namespace smacc
+{
+// counters of the SmaccPoolAllocator. systemAllocations only grows when the pools need
+// more memory, so it must remain constant once the state machine reaches its steady state.
+// They do not cover the rest of the heap allocations of a transition: the node handles that the states
+// create on demand, the shared_ptr and vector members of the events, the components... Those are only
+// counted if the application replaces the global operator new (see setHeapAllocationCounter)
+struct SmaccAllocationStats
+{
+    // objects (states, events, statechart internal nodes) served from the pools
+    std::atomic<uint64_t> poolAllocations;
+    std::atomic<uint64_t> poolDeallocations;
+
+    // memory blocks requested to the system (pool growth and array allocations)
+    std::atomic<uint64_t> systemAllocations;
+    std::atomic<uint64_t> systemBytes;
+
+    static SmaccAllocationStats& instance();
+
+    // counter of all the heap allocations of the process, provided by the application (ie: a benchmark that
+    // replaces the global operator new). nullptr: the heap allocations are not counted
+    static void setHeapAllocationCounter(uint64_t (*counter)());
+
+    // false if there is no heap allocation counter
+    bool countsHeapAllocations() const;
+
+    // all the heap allocations of the process so far (0 if they are not counted)
+    uint64_t heapAllocations() const;
+
+    // prints the current counters into a string
+    void toString(std::stringstream& ss) const;
+
+private:
+    SmaccAllocationStats();
+
+    std::atomic<uint64_t (*)()> heapAllocationCounter_;
+};
+
+// boost pool UserAllocator that counts the memory blocks the pools request to the system
+struct SmaccPoolUserAllocator
+{
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    static char* malloc BOOST_PREVENT_MACRO_SUBSTITUTION(const size_type bytes);
+    static void free BOOST_PREVENT_MACRO_SUBSTITUTION(char* const block);
+};
+
+struct SmaccPoolTag
+{
+};
+
+// Stateless size-class allocator used as the SmaccAllocator of the state machines (states, statechart
+// internals) and of the smacc events. Single objects are served from a thread safe boost::singleton_pool
+// shared by all the types of the same size class (multiple of 16 bytes), so that entering again a state
+// or posting again an event reuses the memory of the previous instance.
+template <typename T>
+class SmaccPoolAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef SmaccPoolAllocator<U> other;
+    };
+
+    SmaccPoolAllocator() noexcept
+    {
+    }
+
+    template <typename U>
+    SmaccPoolAllocator(const SmaccPoolAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n, const void* hint = 0)
+    {
+        auto& stats = SmaccAllocationStats::instance();
+        void* ret;
+        if (n == 1)
+        {
+            stats.poolAllocations.fetch_add(1, std::memory_order_relaxed);
+            ret = Pool::malloc();
+        }
+        else
+        {
+            stats.systemAllocations.fetch_add(1, std::memory_order_relaxed);
+            stats.systemBytes.fetch_add(n * sizeof(T), std::memory_order_relaxed);
+            ret = ::operator new(n * sizeof(T), std::nothrow);
+        }
+
+        if (ret == nullptr)
+            throw std::bad_alloc();
+
+        return static_cast<T*>(ret);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if (n == 1)
+        {
+            SmaccAllocationStats::instance().poolDeallocations.fetch_add(1, std::memory_order_relaxed);
+            Pool::free(p);
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const SmaccPoolAllocator<U>&) const
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const SmaccPoolAllocator<U>&) const
+    {
+        return false;
+    }
+
+private:
+    static const std::size_t SIZE_CLASS = (sizeof(T) + 15) & ~(std::size_t)15;
+
+    typedef boost::singleton_pool<SmaccPoolTag, SIZE_CLASS, SmaccPoolUserAllocator, boost::details::pool::default_mutex, 32> Pool;
+};
+
+template <>
+class SmaccPoolAllocator<void>
+{
+public:
+    typedef void value_type;
+    typedef void* pointer;
+    typedef const void* const_pointer;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef SmaccPoolAllocator<U> other;
+    };
+
+    SmaccPoolAllocator() noexcept
+    {
+    }
+
+    template <typename U>
+    SmaccPoolAllocator(const SmaccPoolAllocator<U>&) noexcept
+    {
+    }
+};
+}
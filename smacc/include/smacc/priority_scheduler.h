@@ -0,0 +1,486 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/latency_histogram.h>
+
+#include <boost/bind.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/function.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/statechart/event.hpp>
+#include <boost/statechart/processor_container.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace smacc
+{
+// Priority classes of the events queued in the scheduler. The lanes with a lower value are drained first
+enum class EventLane : int
+{
+    // safety aborts and the scheduler work items (create, initiate, destroy, terminate)
+    CRITICAL = 0,
+
+    // action results and the events queued without lane
+    RESULT = 1,
+
+    // action feedback
+    FEEDBACK = 2,
+
+    // high rate, low value events (sensor data, progress)
+    TELEMETRY = 3
+};
+
+static const int EVENT_LANE_COUNT = 4;
+
+const char* eventLaneName(EventLane lane);
+
+// what happens when an event is queued into a full lane
+enum class LaneOverflowPolicy : int
+{
+    // the producer waits until the worker thread frees a slot. If there is no worker thread (non blocking
+    // scheduler) or the producer is the worker thread itself, the lane grows instead of waiting
+    BLOCK = 0,
+
+    // the oldest queued event of the lane is discarded
+    DROP_OLDEST = 1,
+
+    // the new event is discarded
+    DROP_NEWEST = 2
+};
+
+struct EventLaneConfig
+{
+    EventLaneConfig(std::size_t capacity = 1024, LaneOverflowPolicy overflowPolicy = LaneOverflowPolicy::BLOCK)
+        : capacity(capacity), overflowPolicy(overflowPolicy)
+    {
+    }
+
+    std::size_t capacity;
+    LaneOverflowPolicy overflowPolicy;
+};
+
+// counters of one lane (snapshot)
+struct EventLaneStats
+{
+    std::size_t depth;
+    std::size_t maxDepth;
+    std::size_t capacity;
+    uint64_t queued;
+    uint64_t dispatched;
+    uint64_t dropped;
+
+    // times that the lane was full and the producer waited or the lane grew
+    uint64_t blocked;
+};
+
+// Replacement of boost::statechart::fifo_worker<> with one bounded fifo per EventLane. operator() always
+// dispatches the oldest work item of the highest priority lane that is not empty, so a critical event or
+// an action result never waits behind the queued feedback events. The items of the same lane keep their
+// order. A single mutex protects all the lanes (same cost than fifo_worker per work item).
+//
+// Each lane counts its depth, the dropped items and the latency from queue_work_item until the item
+// starts its execution.
+class PriorityFifoWorker : boost::noncopyable
+{
+public:
+    typedef boost::function0<void> work_item;
+
+    PriorityFifoWorker(bool waitOnEmptyQueue = false)
+        : waitOnEmptyQueue_(waitOnEmptyQueue), terminated_(false), queuedCount_(0)
+    {
+        setLaneConfig(EventLane::CRITICAL, EventLaneConfig(256, LaneOverflowPolicy::BLOCK));
+        setLaneConfig(EventLane::RESULT, EventLaneConfig(1024, LaneOverflowPolicy::BLOCK));
+        setLaneConfig(EventLane::FEEDBACK, EventLaneConfig(1024, LaneOverflowPolicy::DROP_OLDEST));
+        setLaneConfig(EventLane::TELEMETRY, EventLaneConfig(256, LaneOverflowPolicy::DROP_OLDEST));
+    }
+
+    // The critical lane always uses the BLOCK policy: the scheduler work items cannot be dropped.
+    // The capacity of a lane is never reduced below the number of queued items
+    void setLaneConfig(EventLane lane, EventLaneConfig config)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Lane& l = lanes_[(int)lane];
+
+        if (lane == EventLane::CRITICAL)
+            config.overflowPolicy = LaneOverflowPolicy::BLOCK;
+
+        config.capacity = std::max<std::size_t>(std::max<std::size_t>(config.capacity, 1), l.items.size());
+        l.config = config;
+        l.items.set_capacity(config.capacity);
+    }
+
+    EventLaneConfig getLaneConfig(EventLane lane) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lanes_[(int)lane].config;
+    }
+
+    // work items queued without lane (scheduler management) go to the critical lane
+    void queue_work_item(work_item& item)
+    {
+        queue_work_item(item, EventLane::CRITICAL);
+    }
+
+    void queue_work_item(const work_item& item)
+    {
+        work_item copy = item;
+        queue_work_item(copy, EventLane::CRITICAL);
+    }
+
+    // We take a non-const reference so that we can swap the item into the queue (same semantic than fifo_worker)
+    void queue_work_item(work_item& item, EventLane lane)
+    {
+        if (item.empty())
+        {
+            return;
+        }
+
+        Lane& l = lanes_[(int)lane];
+        work_item dropped;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if (l.items.full())
+            {
+                l.blocked++;
+                switch (l.config.overflowPolicy)
+                {
+                case LaneOverflowPolicy::BLOCK:
+                    if (waitOnEmptyQueue_ && std::this_thread::get_id() != workerThread_)
+                    {
+                        spaceCondition_.wait(lock, [&l] { return !l.items.full(); });
+                    }
+                    else
+                    {
+                        l.items.set_capacity(l.items.capacity() * 2);
+                    }
+                    break;
+
+                case LaneOverflowPolicy::DROP_OLDEST:
+                    // destroyed out of the lock (it may release the last reference of an event)
+                    dropped.swap(l.items.front().item);
+                    l.items.pop_front();
+                    queuedCount_--;
+                    l.dropped++;
+                    break;
+
+                case LaneOverflowPolicy::DROP_NEWEST:
+                    l.dropped++;
+                    return;
+                }
+            }
+
+            l.items.push_back(LaneItem());
+            l.items.back().item.swap(item);
+            l.items.back().queueTime = now();
+            l.queued++;
+            l.maxDepth = std::max(l.maxDepth, l.items.size());
+            queuedCount_++;
+        }
+
+        queueCondition_.notify_one();
+    }
+
+    void queue_work_item(const work_item& item, EventLane lane)
+    {
+        work_item copy = item;
+        queue_work_item(copy, lane);
+    }
+
+    void terminate()
+    {
+        work_item item = boost::bind(&PriorityFifoWorker::terminate_impl, this);
+        queue_work_item(item, EventLane::CRITICAL);
+    }
+
+    // Must only be called from the thread that also calls operator()
+    bool terminated() const
+    {
+        return terminated_;
+    }
+
+    unsigned long operator()(unsigned long maxItemCount = 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workerThread_ = std::this_thread::get_id();
+        }
+
+        unsigned long itemCount = 0;
+
+        while (!terminated() && ((maxItemCount == 0) || (itemCount < maxItemCount)))
+        {
+            work_item item = dequeue_item();
+
+            if (item.empty())
+            {
+                // item can only be empty when the queue is empty, which only happens in non-blocking mode
+                break;
+            }
+
+            item();
+            ++itemCount;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        workerThread_ = std::thread::id();
+        return itemCount;
+    }
+
+    EventLaneStats getLaneStats(EventLane lane) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Lane& l = lanes_[(int)lane];
+
+        EventLaneStats stats;
+        stats.depth = l.items.size();
+        stats.maxDepth = l.maxDepth;
+        stats.capacity = l.items.capacity();
+        stats.queued = l.queued;
+        stats.dispatched = l.dispatched;
+        stats.dropped = l.dropped;
+        stats.blocked = l.blocked;
+        return stats;
+    }
+
+    // time from queue_work_item until the work item starts its execution
+    const LatencyHistogram& getLaneLatency(EventLane lane) const
+    {
+        return lanes_[(int)lane].latency;
+    }
+
+    // prints the counters and the latency of all the lanes into a string
+    void toString(std::stringstream& ss) const
+    {
+        for (int i = 0; i < EVENT_LANE_COUNT; i++)
+        {
+            EventLane lane = (EventLane)i;
+            EventLaneStats stats = getLaneStats(lane);
+            const LatencyHistogram& latency = getLaneLatency(lane);
+
+            ss << eventLaneName(lane) << ": depth " << stats.depth << "/" << stats.capacity << " (max " << stats.maxDepth
+               << "), queued " << stats.queued << ", dispatched " << stats.dispatched << ", dropped " << stats.dropped
+               << ", blocked " << stats.blocked << ", latency mean " << latency.mean() / 1000.0 << " us, p99 < "
+               << latency.percentile(0.99) / 1000.0 << " us" << std::endl;
+        }
+    }
+
+private:
+    struct LaneItem
+    {
+        work_item item;
+        int64_t queueTime;
+    };
+
+    struct Lane
+    {
+        Lane()
+            : maxDepth(0), queued(0), dispatched(0), dropped(0), blocked(0)
+        {
+        }
+
+        EventLaneConfig config;
+        boost::circular_buffer<LaneItem> items;
+
+        std::size_t maxDepth;
+        uint64_t queued;
+        uint64_t dispatched;
+        uint64_t dropped;
+        uint64_t blocked;
+
+        LatencyHistogram latency;
+    };
+
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    work_item dequeue_item()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (waitOnEmptyQueue_)
+        {
+            queueCondition_.wait(lock, [this] { return queuedCount_ > 0; });
+        }
+
+        work_item result;
+        for (Lane& l : lanes_)
+        {
+            if (l.items.empty())
+                continue;
+
+            result.swap(l.items.front().item);
+            l.latency.record(now() - l.items.front().queueTime);
+            l.items.pop_front();
+            l.dispatched++;
+            queuedCount_--;
+
+            lock.unlock();
+            spaceCondition_.notify_all();
+            break;
+        }
+
+        return result;
+    }
+
+    void terminate_impl()
+    {
+        terminated_ = true;
+    }
+
+    const bool waitOnEmptyQueue_;
+    bool terminated_;
+
+    Lane lanes_[EVENT_LANE_COUNT];
+    std::size_t queuedCount_;
+
+    // thread that is executing operator() (producers of this thread never wait for space)
+    std::thread::id workerThread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queueCondition_;
+    std::condition_variable spaceCondition_;
+};
+
+// Same interface than boost::statechart::fifo_scheduler<PriorityFifoWorker, Allocator>, plus a
+// queue_event overload that selects the lane of the event.
+template <class Allocator = std::allocator<void>>
+class PriorityScheduler : boost::noncopyable
+{
+    typedef boost::statechart::processor_container<PriorityScheduler, PriorityFifoWorker::work_item, Allocator> container;
+
+public:
+    PriorityScheduler(bool waitOnEmptyQueue = false)
+        : worker_(waitOnEmptyQueue)
+    {
+    }
+
+    typedef typename container::processor_handle processor_handle;
+    typedef typename container::processor_context processor_context;
+    typedef PriorityFifoWorker::work_item work_item;
+    typedef boost::intrusive_ptr<const boost::statechart::event_base> event_ptr_type;
+
+    template <class Processor, typename... Args>
+    processor_handle create_processor(Args... args)
+    {
+        processor_handle result;
+        work_item item = container_.template create_processor<Processor>(result, *this, args...);
+        worker_.queue_work_item(item);
+        return result;
+    }
+
+    void destroy_processor(const processor_handle& processor)
+    {
+        work_item item = container_.destroy_processor(processor);
+        worker_.queue_work_item(item);
+    }
+
+    void initiate_processor(const processor_handle& processor)
+    {
+        work_item item = container_.initiate_processor(processor);
+        worker_.queue_work_item(item);
+    }
+
+    void terminate_processor(const processor_handle& processor)
+    {
+        work_item item = container_.terminate_processor(processor);
+        worker_.queue_work_item(item);
+    }
+
+    // events queued without lane go to the result lane
+    void queue_event(const processor_handle& processor, const event_ptr_type& pEvent)
+    {
+        queue_event(processor, pEvent, EventLane::RESULT);
+    }
+
+    void queue_event(const processor_handle& processor, const event_ptr_type& pEvent, EventLane lane)
+    {
+        work_item item = container_.queue_event(processor, pEvent);
+        worker_.queue_work_item(item, lane);
+    }
+
+    void queue_work_item(work_item& item)
+    {
+        worker_.queue_work_item(item);
+    }
+
+    void queue_work_item(const work_item& item)
+    {
+        worker_.queue_work_item(item);
+    }
+
+    void terminate()
+    {
+        worker_.terminate();
+    }
+
+    // Must only be called from the thread that also calls operator()
+    bool terminated() const
+    {
+        return worker_.terminated();
+    }
+
+    unsigned long operator()(unsigned long maxEventCount = 0)
+    {
+        return worker_(maxEventCount);
+    }
+
+    void setLaneConfig(EventLane lane, const EventLaneConfig& config)
+    {
+        worker_.setLaneConfig(lane, config);
+    }
+
+    EventLaneConfig getLaneConfig(EventLane lane) const
+    {
+        return worker_.getLaneConfig(lane);
+    }
+
+    EventLaneStats getLaneStats(EventLane lane) const
+    {
+        return worker_.getLaneStats(lane);
+    }
+
+    const LatencyHistogram& getLaneLatency(EventLane lane) const
+    {
+        return worker_.getLaneLatency(lane);
+    }
+
+    void toString(std::stringstream& ss) const
+    {
+        worker_.toString(ss);
+    }
+
+private:
+    container container_;
+    PriorityFifoWorker worker_;
+};
+
+// Queues the event in the given lane of the scheduler. The schedulers without lanes
+// (sc::fifo_scheduler) ignore the lane
+template <class Scheduler>
+void queueEvent(Scheduler& scheduler, const typename Scheduler::processor_handle& processor,
+                const boost::intrusive_ptr<const boost::statechart::event_base>& event, EventLane)
+{
+    scheduler.queue_event(processor, event);
+}
+
+template <class Allocator>
+void queueEvent(PriorityScheduler<Allocator>& scheduler, const typename PriorityScheduler<Allocator>::processor_handle& processor,
+                const boost::intrusive_ptr<const boost::statechart::event_base>& event, EventLane lane)
+{
+    scheduler.queue_event(processor, event, lane);
+}
+}
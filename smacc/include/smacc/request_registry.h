@@ -0,0 +1,177 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace smacc
+{
+// Objects stored in a RequestRegistry inherit from this class. It keeps the slot
+// of the object in the registry so that it can be found and removed in O(1)
+struct RequestRegistryEntry
+{
+    RequestRegistryEntry()
+        : registrySlot_(-1), registryGeneration_(0)
+    {
+    }
+
+    // generation of the last request of this object (ie: the last goal of an action client). It has to be
+    // read before checking whether the request finished, and passed to RequestRegistry::remove
+    unsigned long getRegistryGeneration() const
+    {
+        return registryGeneration_.load(std::memory_order_acquire);
+    }
+
+    // only modified by the registry (under its mutex)
+    long registrySlot_;
+
+    // incremented by each RequestRegistry::add, also when the object was already registered
+    std::atomic<unsigned long> registryGeneration_;
+};
+
+// Set of open requests (i.e. action clients waiting for a result) with O(1) add and remove.
+// The slots are stored in fixed-size chunks that are never reallocated, so that the polling
+// thread can iterate the registry without locks while other threads add or remove requests.
+// Writers are serialized with a mutex that is only held for a few instructions.
+template <typename T, std::size_t ChunkSize = 1024, std::size_t MaxChunks = 1024>
+class RequestRegistry
+{
+public:
+    RequestRegistry()
+        : highWater_(0), size_(0)
+    {
+        for (auto& chunk : chunks_)
+        {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~RequestRegistry()
+    {
+        for (auto& chunk : chunks_)
+        {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    RequestRegistry(const RequestRegistry&) = delete;
+    RequestRegistry& operator=(const RequestRegistry&) = delete;
+
+    // registers a new request of the item. Returns false if the item was already registered: it keeps
+    // its slot, but the older requests can not remove it anymore (see remove)
+    bool add(T* item)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        item->registryGeneration_.fetch_add(1, std::memory_order_acq_rel);
+        if (item->registrySlot_ >= 0)
+            return false;
+
+        std::size_t slot;
+        if (!freeSlots_.empty())
+        {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else
+        {
+            slot = highWater_.load(std::memory_order_relaxed);
+            std::size_t chunkIndex = slot / ChunkSize;
+            if (chunkIndex >= MaxChunks)
+                return false;
+
+            if (chunks_[chunkIndex].load(std::memory_order_relaxed) == nullptr)
+            {
+                auto chunk = new std::atomic<T*>[ChunkSize];
+                for (std::size_t i = 0; i < ChunkSize; i++)
+                    chunk[i].store(nullptr, std::memory_order_relaxed);
+
+                chunks_[chunkIndex].store(chunk, std::memory_order_release);
+            }
+
+            highWater_.store(slot + 1, std::memory_order_release);
+        }
+
+        item->registrySlot_ = slot;
+        at(slot).store(item, std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // returns false if the item was not registered
+    bool remove(T* item)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return removeLocked(item);
+    }
+
+    // removes the item only if its last request is the given generation (read with getRegistryGeneration
+    // before checking that the request finished). Returns false if the item was not registered or if a
+    // newer request was added meanwhile, which keeps the item registered
+    bool remove(T* item, unsigned long generation)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (item->registryGeneration_.load(std::memory_order_relaxed) != generation)
+            return false;
+
+        return removeLocked(item);
+    }
+
+    // calls f(T*) for each registered item. It does not take any lock and f may add or remove items
+    template <typename Function>
+    void forEach(Function f) const
+    {
+        std::size_t count = highWater_.load(std::memory_order_acquire);
+        for (std::size_t slot = 0; slot < count; slot++)
+        {
+            T* item = at(slot).load(std::memory_order_acquire);
+            if (item != nullptr)
+            {
+                f(item);
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // mutex_ must be locked
+    bool removeLocked(T* item)
+    {
+        if (item->registrySlot_ < 0)
+            return false;
+
+        std::size_t slot = item->registrySlot_;
+        at(slot).store(nullptr, std::memory_order_release);
+        item->registrySlot_ = -1;
+        freeSlots_.push_back(slot);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::atomic<T*>& at(std::size_t slot) const
+    {
+        return chunks_[slot / ChunkSize].load(std::memory_order_acquire)[slot % ChunkSize];
+    }
+
+    std::mutex mutex_;
+
+    std::atomic<std::atomic<T*>*> chunks_[MaxChunks];
+
+    // number of slots used at some moment (the iteration range)
+    std::atomic<std::size_t> highWater_;
+
+    std::atomic<std::size_t> size_;
+
+    // released slots, reused before growing the high water mark
+    std::vector<std::size_t> freeSlots_;
+};
+}
@@ -6,18 +6,29 @@
 #pragma once
 
 #include <boost/thread.hpp>
+#include <boost/function.hpp>
 #include <smacc/common.h>
+#include <smacc/smacc_action_client.h>
+#include <smacc/request_registry.h>
+#include <smacc/state_timing.h>
+#include <map>
+#include <mutex>
 
 namespace smacc
 {
+// The signal detector translates the action client results and feedback into events. It can be shared
+// by several state machines: the events are queued in the scheduler of the state machine that owns
+// the action client.
 class SignalDetector
 { 
     public:
-        SignalDetector(SmaccScheduler* scheduler);
+        SignalDetector();
 
         void initialize(ISmaccStateMachine* stateMachine);
 
-        void setProcessorHandle(SmaccScheduler::processor_handle processorHandle);
+        // called each time an event has been queued in the scheduler of some state machine
+        // (used by the SmaccRuntime to know which state machines have pending work)
+        void setEventQueuedCallback(boost::function<void(ISmaccStateMachine*)> callback);
             
         // runs the polling loop into a thread
         void runThread();
@@ -32,6 +43,31 @@ class SignalDetector
 
         void pollingLoop();
 
+        // true if the action client callbacks post their events directly to the scheduler
+        // instead of being polled (parameter: ~signal_detector_event_driven)
+        bool isEventDriven() const;
+
+        // event-driven mode: called from the actionlib done callback of the client
+        void onActionResult(ISmaccActionClient* client);
+
+        // event-driven mode: called from the actionlib feedback callback of the client
+        void onActionFeedback(ISmaccActionClient* client);
+
+        // queues an event of the action client (other than results and feedback) in the scheduler of its state machine
+        void postEvent(ISmaccActionClient* client, const boost::intrusive_ptr<const sc::event_base>& event, EventLane lane);
+
+        // queues an event of some other event source (ie: SmaccTopicSubscriber) in the scheduler of the state machine
+        void postEvent(ISmaccStateMachine* stateMachine, const boost::intrusive_ptr<const sc::event_base>& event, EventLane lane);
+
+        // state machines that use this signal detector
+        std::vector<ISmaccStateMachine*> getStateMachines();
+
+        // namespace of the state machine that will be created in the scheduler (SmaccRuntime instances). The
+        // state machine reads it in its constructor ("" if it was not set)
+        void setInstanceNamespace(const SmaccScheduler* scheduler, const std::string& ns);
+
+        std::string getInstanceNamespace(const SmaccScheduler* scheduler);
+
     private:
 
         void finalizeRequest(ISmaccActionClient* resource);
@@ -40,20 +76,38 @@ class SignalDetector
 
         void registerActionClientRequest(ISmaccActionClient* actionClientRequestInfo);
 
-        SmaccScheduler* scheduler_;
+        void onEventQueued(ISmaccActionClient* client);
+
+        // timing tables of the state machine types that use this signal detector
+        std::vector<StateTimingTable*> getStateTimingTables();
+
+        void publishStateTimings(const ros::WallTimerEvent&);
 
-        SmaccScheduler::processor_handle processorHandle_;
+        // writes the state timing tables into a csv file (parameter: ~smacc_state_timing_file, empty by default: disabled)
+        void dumpStateTimings(const std::string& path);
+
+        ros::Publisher stateTimingsPub_;
+        ros::WallTimer stateTimingsTimer_;
+
+        boost::function<void(ISmaccStateMachine*)> eventQueuedCallback_;
 
         boost::thread signalDetectorThread_ ;
         
-        ISmaccStateMachine* smaccStateMachine_;
+        // state machines that use this signal detector
+        std::vector<ISmaccStateMachine*> stateMachines_;
+        std::map<const SmaccScheduler*, std::string> instanceNamespaces_;
+        std::mutex stateMachinesMutex_;
 
-        // TODO: this should be thread safe since it may be updated from others threads
-        std::vector<ISmaccActionClient*> openRequests_;
+        // requests may be registered from several state machine threads while the
+        // polling loop iterates them. Registering and finalizing a request is O(1)
+        RequestRegistry<ISmaccActionClient> openRequests_;
 
         // loop frequency of the signal detector (to check answers from actionservers)
         double loop_rate_hz;
 
+        // if true the action clients results and feedback are not polled
+        bool eventDriven_;
+
         friend class ISmaccStateMachine;
 };
 }
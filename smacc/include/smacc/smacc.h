@@ -7,6 +7,8 @@
 #include <smacc/common.h>
 #include <smacc/smacc_state_machine_base.h>
 #include <smacc/signal_detector.h>
+#include <smacc/smacc_runtime.h>
+#include <smacc/event_replay.h>
 
 namespace smacc
 {
@@ -15,6 +17,7 @@ namespace smacc
   // it uses two threads: a new thread and the current one. 
   // The created thread is for the state machine process 
   // it locks the current thread to handle events of the state machine 
+  // (see SmaccRuntime to run several state machines in the same process)
   template <typename StateMachineType>
   void run()
   {
@@ -22,19 +25,18 @@ namespace smacc
     SmaccScheduler scheduler1(true);
 
     // create the signalDetector component
-    SignalDetector signalDetector(&scheduler1);
+    SignalDetector signalDetector;
 
     // create the asynchronous state machine processor
     SmaccScheduler::processor_handle sm =
         scheduler1.create_processor<StateMachineType>(&signalDetector);
     
     // initialize the asynchronous state machine processor
-    signalDetector.setProcessorHandle(sm);
     scheduler1.initiate_processor(sm);
 
     //create a thread for the asynchronous state machine processor execution
     boost::thread otherThread(
-        boost::bind(&sc::fifo_scheduler<>::operator(), &scheduler1, 0));
+        boost::bind(&SmaccScheduler::operator(), &scheduler1, 0));
 
     // use the  main thread for the signal detector component (waiting actionclient requests)
     signalDetector.pollingLoop();
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <smacc/component.h>
+#include <smacc/request_registry.h>
 #include <actionlib/client/simple_action_client.h>
 
 namespace smacc
@@ -14,8 +15,9 @@ namespace smacc
 using namespace actionlib;
 
 // This class interface shows the basic set of methods that
-// a SMACC "resource" or "plugin" Action Client has
-class ISmaccActionClient: public ISmaccComponent
+// a SMACC "resource" or "plugin" Action Client has.
+// While it has an open request it is stored in the request registry of the SignalDetector
+class ISmaccActionClient: public ISmaccComponent, public RequestRegistryEntry
 {
 public:
 
@@ -27,6 +29,8 @@ public:
 
     virtual void init(ros::NodeHandle& nh) override;
 
+    virtual void initOffline(ros::NodeHandle& nh) override;
+
     // return the current state of the actionclient
     virtual SimpleClientGoalState getState()=0;
 
@@ -42,8 +46,8 @@ public:
 protected:
     virtual void postEvent(SmaccScheduler* scheduler, SmaccScheduler::processor_handle processorHandle)=0;
 
-    // used internally by the Signal detector
-    virtual void postFeedbackEvent(SmaccScheduler* scheduler, SmaccScheduler::processor_handle processorHandle)=0;
+    // used internally by the Signal detector. Returns true if some feedback event was queued
+    virtual bool postFeedbackEvent(SmaccScheduler* scheduler, SmaccScheduler::processor_handle processorHandle)=0;
 
     // the ros path where the action is located
     std::string name_;
@@ -6,7 +6,12 @@
 #pragma once
 
 #include <smacc/smacc_action_client.h>
-#include <queue>
+#include <smacc/signal_detector.h>
+#include <smacc/feedback_channel.h>
+#include <smacc/event_codec.h>
+#include <smacc/intra_process_action_server.h>
+#include <atomic>
+#include <mutex>
 
 namespace smacc
 {
@@ -28,71 +33,524 @@ class SmaccActionClientBase: public ISmaccActionClient
     typedef typename ActionClient::SimpleFeedbackCallback SimpleFeedbackCallback;
 
     SmaccActionClientBase(int feedback_queue_size=10)
-        :ISmaccActionClient()
+        :ISmaccActionClient(), feedback_channel_(feedback_queue_size),
+        feedback_batching_(false), max_feedback_batch_size_(0),
+        result_state_(SimpleClientGoalState::LOST), result_captured_(false),
+        intra_process_(true), intra_process_goal_(false), goal_id_(0),
+        intra_process_state_(SimpleClientGoalState::LOST), intra_process_goal_count_(0),
+        goal_pending_(false), actionlib_goal_tracked_(false), deferred_goal_count_(0), connection_timeout_count_(0)
     {
-        feedback_queue_size_= feedback_queue_size;
+        // so that the result and feedback events can be recorded and replayed
+        registerActionEventCodecs<Result, Feedback>();
     }
 
     virtual void init(ros::NodeHandle& nh) override
     {
         ISmaccActionClient::init(nh);
-        client_ = std::make_shared<ActionClient>(name_,false) ;
+
+        // the actionlib callbacks go to the callback queue of nh (the dedicated queue of this component, if any)
+        ros::NodeHandle clientNh;
+        clientNh.setCallbackQueue(nh.getCallbackQueue());
+        client_ = std::make_shared<ActionClient>(clientNh, name_, false);
+
+        // 0: the goals wait for the action server forever
+        double connectionTimeout;
+        ros::NodeHandle("~").param("action_server_connection_timeout", connectionTimeout, 0.0);
+        connection_timeout_ = ros::WallDuration(connectionTimeout);
+
+        // the goals are sent to an IntraProcessActionServer of this process, if there is one with this name
+        ros::NodeHandle("~").param("smacc_intra_process_actions", intra_process_, true);
     }
 
     virtual ~SmaccActionClientBase()
     {
+        // the members used by the callbacks are destroyed after this
+        SmaccActionClientBase<ActionType>::shutdown();
+    }
+
+    virtual void shutdown() override
+    {
+        ISmaccActionClient::shutdown();
+
+        // stop waits for the running timer callback, that locks goal_mutex_
+        ros::WallTimer connectionTimer;
+        {
+            std::lock_guard<std::mutex> lock(goal_mutex_);
+            connectionTimer = connection_timer_;
+            connection_timer_ = ros::WallTimer();
+        }
+        connectionTimer.stop();
+    }
+
+    // waits for the action server (offline mode: there is no server to wait for)
+    virtual bool waitUntilReady(ros::WallDuration timeout) override
+    {
+        if(!client_)
+            return true;
+
+        if(isServerConnected())
+            return true;
+
+        if(timeout.isZero())
+            return false;
+
+        return client_->waitForServer(ros::Duration(timeout.toSec()));
+    }
+
+    // connected with the actionlib server or there is an intra-process server with the action name
+    bool isServerConnected()
+    {
+        return isIntraProcessServerAvailable() || client_->isServerConnected();
+    }
+
+    bool isIntraProcessServerAvailable()
+    {
+        return intra_process_ && IntraProcessActionServer<ActionType>::exists(name_);
+    }
+
+    // goals sent to an intra-process server (the rest were sent through actionlib)
+    unsigned long getIntraProcessGoalCount() const
+    {
+        return intra_process_goal_count_.load(std::memory_order_relaxed);
     }
 
     virtual void cancelGoal()
     {
         ROS_INFO("Cancelling goal of %s", this->getName().c_str());
-        client_->cancelGoal();
+        if(!client_)
+            return;
+
+        ros::WallTimer connectionTimer;
+        {
+            std::lock_guard<std::mutex> lock(goal_mutex_);
+            if(goal_pending_)
+            {
+                // the goal was not sent yet
+                connectionTimer = discardPendingGoal();
+            }
+        }
+
+        if(connectionTimer.isValid())
+            connectionTimer.stop();
+        else if(intra_process_goal_.load(std::memory_order_acquire))
+            IntraProcessActionServer<ActionType>::cancelGoal(name_);
+        else
+            client_->cancelGoal();
+    }
+
+    // max time that a goal waits for the action server to connect (0: no limit).
+    // The default value is read from the ~action_server_connection_timeout parameter
+    void setServerConnectionTimeout(ros::WallDuration timeout)
+    {
+        std::lock_guard<std::mutex> lock(goal_mutex_);
+        connection_timeout_ = timeout;
+    }
+
+    // goals that were sent while the action server was not connected
+    unsigned long getDeferredGoalCount()
+    {
+        std::lock_guard<std::mutex> lock(goal_mutex_);
+        return deferred_goal_count_;
     }
 
+    unsigned long getServerConnectionTimeoutCount()
+    {
+        std::lock_guard<std::mutex> lock(goal_mutex_);
+        return connection_timeout_count_;
+    }
+
+    // time that the state machine thread would have been blocked in waitForServer
+    // (from sendGoal until the goal was sent, discarded or cancelled)
+    ros::WallDuration getAvoidedStallTime()
+    {
+        std::lock_guard<std::mutex> lock(goal_mutex_);
+        return avoided_stall_time_;
+    }
+
+    // in offline mode (initOffline) there is no actionlib client
     virtual SimpleClientGoalState getState() override
     {
-        return client_->getState();
+        if(intra_process_goal_.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            return intra_process_state_;
+        }
+
+        return client_ ? client_->getState() : result_state_;
     }
 
     virtual bool hasFeedback() override
     {
-        return !feedback_queue_.empty();
+        return !feedback_channel_.empty();
     }
 
+    // selects how the feedback messages are delivered. It has to be called before sending the first goal
+    void setFeedbackPolicy(FeedbackPolicy policy, unsigned int decimation = 1)
+    {
+        feedback_channel_.setPolicy(policy, decimation);
+    }
+
+    // what happens when the feedback messages arrive faster than the state machine consumes them (default:
+    // the oldest pending message is dropped). It has to be called before sending the first goal
+    void setFeedbackOverflowPolicy(FeedbackOverflowPolicy overflowPolicy)
+    {
+        feedback_channel_.setOverflowPolicy(overflowPolicy);
+    }
+
+    // if enabled, the pending feedback messages are posted in EvActionFeedbackBatch events instead of one
+    // EvActionFeedback per message. maxBatchSize = 0: no limit. It has to be called before sending the first goal
+    void setFeedbackBatching(bool enabled, std::size_t maxBatchSize = 0)
+    {
+        feedback_batching_ = enabled;
+        max_feedback_batch_size_ = maxBatchSize;
+    }
+
+    bool isFeedbackBatching() const
+    {
+        return feedback_batching_;
+    }
+
+    // feedback messages lost because the state machine did not consume them fast enough
+    unsigned long getDroppedFeedbackCount() const
+    {
+        return feedback_channel_.getDroppedCount();
+    }
+
+    // feedback messages discarded by the feedback policy
+    unsigned long getCoalescedFeedbackCount() const
+    {
+        return feedback_channel_.getCoalescedCount();
+    }
+
+    // offline mode (no actionlib client): called for each goal instead of sending it, it answers the goal with
+    // deliverOfflineFeedback / deliverOfflineResult (ie: the simulated servers of a benchmark). Empty: the goals
+    // are not answered
+    typedef boost::function<void(SmaccActionClientBase<ActionType>&, const Goal&)> OfflineGoalHandler;
+
+    static void setOfflineGoalHandler(const OfflineGoalHandler& handler)
+    {
+        std::lock_guard<std::mutex> lock(offlineGoalHandlerMutex());
+        offlineGoalHandler() = handler;
+    }
+
+    static OfflineGoalHandler getOfflineGoalHandler()
+    {
+        std::lock_guard<std::mutex> lock(offlineGoalHandlerMutex());
+        return offlineGoalHandler();
+    }
+
+    // offline mode: the answers of the offline goal handler, as if they came from actionlib
+    void deliverOfflineFeedback(const FeedbackConstPtr& feedback)
+    {
+        onFeedback(feedback);
+    }
+
+    void deliverOfflineResult(const SimpleClientGoalState& state, const ResultConstPtr& result)
+    {
+        onResult(state, result);
+    }
+
+    // It never blocks. If the action server is not connected yet, the goal is kept and it is sent as soon as
+    // the server connects (EvActionServerConnected) or discarded after the connection timeout
+    // (EvActionServerTimeout). A new goal or cancelGoal replace or discard the pending goal
     void sendGoal(Goal& goal)
     {
         ROS_INFO_STREAM("Sending goal to actionserver located in " << this->name_ <<"\"");
+
+        if(!client_)
+        {
+            // offline mode: the goal is answered by the offline goal handler (ie: a simulated server)
+            // or the result is replayed from the event log
+            OfflineGoalHandler handler = getOfflineGoalHandler();
+            if(handler)
+                handler(*this, goal);
+            else
+                ROS_DEBUG("%s: offline, the goal is not sent", getName().c_str());
+            return;
+        }
         
-        if(!client_->isServerConnected())
+        ros::WallTimer connectionTimer;
         {
-            ROS_INFO("%s [at %s]: not connected with actionserver, waiting ..." , getName().c_str(), getNamespace().c_str());
-            client_->waitForServer();
+            std::lock_guard<std::mutex> lock(goal_mutex_);
+            if(!isServerConnected())
+            {
+                ROS_INFO("%s [at %s]: not connected with actionserver, the goal is sent when it connects" , getName().c_str(), getNamespace().c_str());
+                pending_goal_ = goal;
+                if(!goal_pending_)
+                {
+                    goal_pending_ = true;
+                    pending_since_ = ros::WallTime::now();
+                    deferred_goal_count_++;
+
+                    // it is dispatched by the signal detector loop (global callback queue) or by the spinner
+                    // of the dedicated callback queue of this component
+                    ros::NodeHandle timerNh;
+                    if(this->getCallbackQueue() != nullptr)
+                        timerNh.setCallbackQueue(this->getCallbackQueue());
+
+                    connection_timer_ = timerNh.createWallTimer(ros::WallDuration(CONNECTION_CHECK_PERIOD),
+                                            &SmaccActionClientBase<ActionType>::onConnectionCheck, this);
+                }
+                return;
+            }
+
+            if(goal_pending_)
+            {
+                // the server connected before the check: the new goal replaces the pending one
+                connectionTimer = discardPendingGoal();
+            }
+
+            sendGoalToServer(goal);
         }
 
+        connectionTimer.stop();
+    }
+
+protected:
+    static constexpr double CONNECTION_CHECK_PERIOD = 0.05;
+
+    // goal_mutex_ must be locked
+    void sendGoalToServer(const Goal& goal)
+    {
         ROS_INFO_STREAM(getName()<< ": Goal Value: " << std::endl << goal);
 
-        SimpleDoneCallback done_cb ;
-        SimpleActiveCallback active_cb;
-        SimpleFeedbackCallback feedback_cb = boost::bind(&SmaccActionClientBase<ActionType>::onFeedback,this,_1);
+        // the callbacks of the goals that were replaced by a newer one (of any transport) are ignored
+        uint64_t goalId;
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            result_.reset();
+            result_captured_ = false;
+            goalId = ++goal_id_;
+        }
+
+        bool previousIntraProcess = intra_process_goal_.load(std::memory_order_acquire);
+        if(intra_process_ && sendIntraProcessGoal(goal, goalId))
+        {
+            // the goal of the actionlib server is not replaced by the new one: it is cancelled, so the server
+            // does not keep working on it, and it is not tracked anymore, so its feedback is not delivered
+            if(actionlib_goal_tracked_)
+            {
+                if(!client_->getState().isDone())
+                    client_->cancelGoal();
+                client_->stopTrackingGoal();
+                actionlib_goal_tracked_ = false;
+            }
+        }
+        else
+        {
+            intra_process_goal_.store(false, std::memory_order_release);
+            if(previousIntraProcess)
+                IntraProcessActionServer<ActionType>::cancelGoal(name_);
+
+            SimpleDoneCallback done_cb = [this, goalId](const SimpleClientGoalState& state, const ResultConstPtr& result)
+            {
+                onActionlibResult(goalId, state, result);
+            };
+            SimpleActiveCallback active_cb;
+            SimpleFeedbackCallback feedback_cb = [this, goalId](const FeedbackConstPtr& feedback)
+            {
+                if(goalId == goal_id_.load(std::memory_order_acquire))
+                    onFeedback(feedback);
+            };
 
-        client_->sendGoal(goal,done_cb,active_cb,feedback_cb);
+            client_->sendGoal(goal,done_cb,active_cb,feedback_cb);
+            actionlib_goal_tracked_ = true;
+        }
 
         stateMachine_->registerActionClientRequest(this);
     }
 
-protected:
+    // goal_mutex_ must be locked. The goal is copied once, the feedback and result messages of the server
+    // are delivered without copies. Returns false if there is no intra-process server with the action name
+    bool sendIntraProcessGoal(const Goal& goal, uint64_t goalId)
+    {
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            intra_process_state_ = SimpleClientGoalState::ACTIVE;
+            intra_process_goal_.store(true, std::memory_order_release);
+        }
+
+        // the callbacks of the goals that were replaced by a newer one are ignored (as actionlib does)
+        bool sent = IntraProcessActionServer<ActionType>::sendGoal(name_, boost::make_shared<const Goal>(goal),
+            [this, goalId](const FeedbackConstPtr& feedback)
+            {
+                if(goalId == goal_id_.load(std::memory_order_acquire))
+                    onFeedback(feedback);
+            },
+            [this, goalId](const SimpleClientGoalState& state, const ResultConstPtr& result)
+            {
+                onIntraProcessResult(goalId, state, result);
+            });
+
+        if(sent)
+            intra_process_goal_count_.fetch_add(1, std::memory_order_relaxed);
+
+        return sent;
+    }
+
+    // goal_mutex_ must be locked. The returned timer has to be stopped after unlocking the mutex
+    // (stop waits for the running timer callback, that locks goal_mutex_)
+    ros::WallTimer discardPendingGoal()
+    {
+        goal_pending_ = false;
+        avoided_stall_time_ += ros::WallTime::now() - pending_since_;
+
+        ros::WallTimer connectionTimer = connection_timer_;
+        connection_timer_ = ros::WallTimer();
+        return connectionTimer;
+    }
+
+    // called periodically while a goal waits for the action server
+    void onConnectionCheck(const ros::WallTimerEvent&)
+    {
+        boost::intrusive_ptr<const sc::event_base> ev;
+        ros::WallTimer connectionTimer;
+        {
+            std::lock_guard<std::mutex> lock(goal_mutex_);
+            if(!goal_pending_)
+                return;
+
+            ros::WallDuration waitTime = ros::WallTime::now() - pending_since_;
+            if(isServerConnected())
+            {
+                ROS_INFO("%s: actionserver connected after %lf seconds, sending the pending goal", getName().c_str(), waitTime.toSec());
+                sendGoalToServer(pending_goal_);
+
+                EvActionServerConnected<Result>* connectedEvent = new EvActionServerConnected<Result>();
+                connectedEvent->client = this;
+                connectedEvent->waitTime = waitTime;
+                ev = connectedEvent;
+            }
+            else if(!connection_timeout_.isZero() && waitTime >= connection_timeout_)
+            {
+                ROS_WARN("%s: actionserver not connected after %lf seconds, the goal is discarded", getName().c_str(), waitTime.toSec());
+                connection_timeout_count_++;
+
+                EvActionServerTimeout<Result>* timeoutEvent = new EvActionServerTimeout<Result>();
+                timeoutEvent->client = this;
+                timeoutEvent->waitTime = waitTime;
+                ev = timeoutEvent;
+            }
+            else
+            {
+                return;
+            }
+
+            connectionTimer = discardPendingGoal();
+        }
+
+        connectionTimer.stop();
+
+        stateMachine_->getSignalDetector()->postEvent(this, ev, EventLane::RESULT);
+    }
+
     std::shared_ptr<ActionClient> client_;
-    int feedback_queue_size_;
-    std::list<Feedback> feedback_queue_;
+
+    // written by the actionlib feedback callback, read by the signal detector
+    FeedbackChannel<Feedback> feedback_channel_;
+
+    bool feedback_batching_;
+    std::size_t max_feedback_batch_size_;
 
     void onFeedback(const FeedbackConstPtr & feedback)
     {
-        Feedback copy = *feedback;
-        feedback_queue_.push_back(copy);
-        ROS_DEBUG("FEEDBACK MESSAGE RECEIVED, Queue Size: %ld", feedback_queue_.size());
-        if(feedback_queue_.size()> feedback_queue_size_)
+        feedback_channel_.push(feedback);
+        ROS_DEBUG("[%s] FEEDBACK MESSAGE RECEIVED", this->getName().c_str());
+        SMACC_TRACE("action_client/feedback", this, feedback_channel_.getDroppedCount(), feedback_channel_.getCoalescedCount());
+
+        SignalDetector* signalDetector = stateMachine_->getSignalDetector();
+        if(signalDetector->isEventDriven())
+        {
+            signalDetector->onActionFeedback(this);
+        }
+    }
+
+    // result of the last goal, captured in the done callback and moved into the EvActionResult event
+    std::mutex result_mutex_;
+    ResultConstPtr result_;
+    SimpleClientGoalState result_state_;
+    bool result_captured_;
+
+    // intra-process transport (IntraProcessActionServer): intra_process_goal_ is true while the last goal
+    // was sent to an intra-process server, the other fields are protected by result_mutex_
+    bool intra_process_;
+    std::atomic<bool> intra_process_goal_;
+
+    // id of the last goal (of any transport), incremented with result_mutex_ locked
+    std::atomic<uint64_t> goal_id_;
+    SimpleClientGoalState intra_process_state_;
+    std::atomic<unsigned long> intra_process_goal_count_;
+
+    // goal sent before the action server was connected. It is sent by onConnectionCheck
+    std::mutex goal_mutex_;
+    Goal pending_goal_;
+    bool goal_pending_;
+    ros::WallTime pending_since_;
+
+    // the actionlib client tracks a goal (it has to be cancelled when the next one is sent intra-process)
+    bool actionlib_goal_tracked_;
+    ros::WallTimer connection_timer_;
+    ros::WallDuration connection_timeout_;
+
+    unsigned long deferred_goal_count_;
+    unsigned long connection_timeout_count_;
+    ros::WallDuration avoided_stall_time_;
+
+    void onResult(const SimpleClientGoalState& state, const ResultConstPtr & result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            result_ = result;
+            result_state_ = state;
+            result_captured_ = true;
+        }
+
+        SignalDetector* signalDetector = stateMachine_->getSignalDetector();
+        if(signalDetector->isEventDriven())
         {
-            feedback_queue_.pop_front();
+            signalDetector->onActionResult(this);
+        }
+    }
+
+    // done callback of the actionlib goals. The results of the replaced goals are ignored
+    void onActionlibResult(uint64_t goalId, const SimpleClientGoalState& state, const ResultConstPtr & result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            if(goalId != goal_id_.load(std::memory_order_relaxed))
+                return;
+
+            result_ = result;
+            result_state_ = state;
+            result_captured_ = true;
+        }
+
+        SignalDetector* signalDetector = stateMachine_->getSignalDetector();
+        if(signalDetector->isEventDriven())
+        {
+            signalDetector->onActionResult(this);
+        }
+    }
+
+    // the state is updated with the result, so that the polling signal detector never sees the goal
+    // finished before the result is captured
+    void onIntraProcessResult(uint64_t goalId, const SimpleClientGoalState& state, const ResultConstPtr & result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            if(goalId != goal_id_.load(std::memory_order_relaxed))
+                return;
+
+            result_ = result;
+            result_state_ = state;
+            result_captured_ = true;
+            intra_process_state_ = state;
+        }
+
+        SignalDetector* signalDetector = stateMachine_->getSignalDetector();
+        if(signalDetector->isEventDriven())
+        {
+            signalDetector->onActionResult(this);
         }
     }
 
@@ -103,35 +561,97 @@ protected:
         boost::intrusive_ptr< EvActionResult<Result>> actionClientResultEvent = ev;
         actionClientResultEvent->client = this;
 
-        scheduler->queue_event(processorHandle, actionClientResultEvent);
+        bool captured;
+        {
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            captured = result_captured_;
+            actionClientResultEvent->resultMessage = std::move(result_);
+            actionClientResultEvent->resultState = result_state_;
+            result_captured_ = false;
+        }
+
+        if(!captured && !intra_process_goal_.load(std::memory_order_acquire))
+        {
+            // the polling signal detector saw the goal finished before the done callback was called
+            actionClientResultEvent->resultState = client_->getState();
+            actionClientResultEvent->resultMessage = client_->getResult();
+        }
+
+        // the result is not delayed by the feedback events that are still queued
+        actionClientResultEvent->markQueued();
+        queueEvent(*scheduler, processorHandle, actionClientResultEvent, EventLane::RESULT);
     }
     
-    virtual void postFeedbackEvent(SmaccScheduler* scheduler, SmaccScheduler::processor_handle processorHandle) override
+    // posts one event for each pending feedback message (or one event for all of them if batching is enabled)
+    virtual bool postFeedbackEvent(SmaccScheduler* scheduler, SmaccScheduler::processor_handle processorHandle) override
     {
-        boost::intrusive_ptr< EvActionFeedback<Feedback> > actionFeedbackEvent = new EvActionFeedback<Feedback>();
-        actionFeedbackEvent->client = this;
+        if(feedback_batching_)
+        {
+            return postFeedbackBatchEvents(scheduler, processorHandle);
+        }
 
         bool ok = false;
-        if(!feedback_queue_.empty())
+        FeedbackConstPtr feedback_msg;
+        while(feedback_channel_.pop(feedback_msg))
         {
-            ROS_DEBUG("[%s]Popping FEEDBACK MESSAGE, Queue Size: %ld", this->getName().c_str(), feedback_queue_.size());
-            Feedback feedback_msg = feedback_queue_.front();
-            feedback_queue_.pop_front();
-            ROS_DEBUG("[%s]popped FEEDBACK MESSAGE, Queue Size: %ld", this->getName().c_str(), feedback_queue_.size());
-            actionFeedbackEvent->feedbackMessage = feedback_msg;
+            boost::intrusive_ptr< EvActionFeedback<Feedback> > actionFeedbackEvent = new EvActionFeedback<Feedback>();
+            actionFeedbackEvent->client = this;
+            actionFeedbackEvent->feedbackMessage = std::move(feedback_msg);
+
+            actionFeedbackEvent->markQueued();
+            queueEvent(*scheduler, processorHandle, actionFeedbackEvent, EventLane::FEEDBACK);
             ok = true;
         }
-        else
+
+        return ok;
+    }
+
+    bool postFeedbackBatchEvents(SmaccScheduler* scheduler, SmaccScheduler::processor_handle processorHandle)
+    {
+        bool ok = false;
+        boost::intrusive_ptr< EvActionFeedbackBatch<Feedback> > batchEvent;
+        FeedbackConstPtr feedback_msg;
+        while(feedback_channel_.pop(feedback_msg))
         {
-            ok = false;
-        };
+            if(!batchEvent)
+            {
+                batchEvent = new EvActionFeedbackBatch<Feedback>();
+                batchEvent->client = this;
+                batchEvent->feedbackMessages.reserve(max_feedback_batch_size_ > 0 ? max_feedback_batch_size_ : feedback_channel_.capacity());
+            }
+
+            batchEvent->feedbackMessages.push_back(std::move(feedback_msg));
 
-        if(ok)
+            if(batchEvent->feedbackMessages.size() == max_feedback_batch_size_)
+            {
+                batchEvent->markQueued();
+                queueEvent(*scheduler, processorHandle, batchEvent, EventLane::FEEDBACK);
+                batchEvent.reset();
+                ok = true;
+            }
+        }
+
+        if(batchEvent)
         {
-            //ROS_INFO("Sending feedback event");
-            scheduler->queue_event(processorHandle, actionFeedbackEvent);
+            batchEvent->markQueued();
+            queueEvent(*scheduler, processorHandle, batchEvent, EventLane::FEEDBACK);
+            ok = true;
         }
-    }    
+
+        return ok;
+    }
+
+    static std::mutex& offlineGoalHandlerMutex()
+    {
+        static std::mutex instance;
+        return instance;
+    }
+
+    static OfflineGoalHandler& offlineGoalHandler()
+    {
+        static OfflineGoalHandler instance;
+        return instance;
+    }
 
     friend class SignalDetector;
 };
@@ -0,0 +1,161 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/common.h>
+#include <smacc/signal_detector.h>
+#include <smacc/smacc_state_machine.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace smacc
+{
+// Hosts many state machines (of the same or different types) in a single process.
+//
+// Each state machine has its own SmaccScheduler (in non-blocking mode) so that it can be executed
+// by any thread of the pool. The state machines with pending events are pushed into the queue of one
+// of the worker threads and idle workers steal them from the other queues. The events of one state
+// machine are always processed by one thread at a time, in FIFO order.
+//
+// All the state machines share a single SignalDetector, whose loop runs in the thread that calls run().
+//
+// usage:
+//     smacc::SmaccRuntime runtime;
+//     runtime.addStateMachine<RadialMotionStateMachine>(500, "robot_%d");
+//     runtime.addStateMachine<WayPointsStateMachine>();
+//     runtime.run();
+//
+// The events of other threads must be queued with ISmaccStateMachine::postEvent (not directly in its scheduler),
+// so that the runtime is notified that the state machine has pending work.
+class SmaccRuntime
+{
+public:
+    // threadCount = 0: it is read from the ~smacc_runtime_threads parameter
+    // (hardware concurrency by default)
+    SmaccRuntime(int threadCount = 0);
+
+    virtual ~SmaccRuntime();
+
+    // creates and initiates N instances of the state machine type. It must be called before run()
+    // namespaceFormat: printf format of the namespace of each instance, whose %d is the index of the instance
+    // (ie: "robot_%d"). The node handles of the state machine, its states and its components are resolved inside
+    // it. Empty: all the instances share the namespace of the state machine type (and its topics and parameters)
+    template <typename StateMachineType>
+    void addStateMachine(int instances = 1, const std::string& namespaceFormat = "")
+    {
+        if (instances > 1 && namespaceFormat.empty())
+        {
+            ROS_WARN("SmaccRuntime: the %d instances of %s share the same namespace", instances,
+                     rosTypeName<StateMachineType>().c_str());
+        }
+
+        for (int i = 0; i < instances; i++)
+        {
+            auto hosted = std::make_shared<HostedStateMachine>();
+            hosted->scheduler.reset(new SmaccScheduler(false));
+            if (!namespaceFormat.empty())
+            {
+                signalDetector_.setInstanceNamespace(hosted->scheduler.get(),
+                                                     ros::NodeHandle(formatNamespace(namespaceFormat, i)).getNamespace());
+            }
+
+            hosted->handle = hosted->scheduler->template create_processor<StateMachineType>(&signalDetector_);
+            hosted->scheduler->initiate_processor(hosted->handle);
+
+            stateMachines_.push_back(hosted);
+            schedulerIndex_[hosted->scheduler.get()] = hosted.get();
+
+            // process the creation and initiation work items
+            schedule(hosted.get());
+        }
+    }
+
+    // starts the worker threads and runs the signal detector loop in the current thread until ros shutdown
+    void run();
+
+    // stops the worker threads
+    void stop();
+
+    SignalDetector& getSignalDetector();
+
+    int getThreadCount() const;
+
+    int getStateMachineCount() const;
+
+    // number of times that some worker thread took a state machine from the queue of another worker
+    unsigned long getStealCount() const;
+
+private:
+    enum class HostedStatus : int
+    {
+        IDLE = 0,
+        SCHEDULED = 1,
+        RUNNING = 2,
+        RUNNING_RESCHEDULE = 3
+    };
+
+    struct HostedStateMachine
+    {
+        HostedStateMachine();
+
+        std::unique_ptr<SmaccScheduler> scheduler;
+        SmaccScheduler::processor_handle handle;
+        std::atomic<int> status;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<HostedStateMachine*> ready;
+    };
+
+    static std::string formatNamespace(const std::string& format, int index);
+
+    // called by the signal detector when some event was queued in some state machine
+    void onEventQueued(ISmaccStateMachine* stateMachine);
+
+    // marks the state machine as ready (if it was not already ready or running)
+    void schedule(HostedStateMachine* hosted);
+
+    void push(HostedStateMachine* hosted);
+
+    HostedStateMachine* pop(int workerIndex);
+
+    void execute(HostedStateMachine* hosted);
+
+    void workerLoop(int workerIndex);
+
+    SignalDetector signalDetector_;
+
+    std::vector<std::shared_ptr<HostedStateMachine>> stateMachines_;
+
+    // it is only modified before run(), so that it can be read without locks
+    std::unordered_map<SmaccScheduler*, HostedStateMachine*> schedulerIndex_;
+
+    int threadCount_;
+
+    // max number of events that a worker processes of the same state machine before rescheduling it
+    unsigned long batchSize_;
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<boost::thread> workers_;
+
+    std::atomic<bool> stopping_;
+    std::atomic<int> pendingCount_;
+    std::atomic<int> idleWorkers_;
+    std::atomic<unsigned long> nextQueue_;
+    std::atomic<unsigned long> stealCount_;
+
+    std::mutex idleMutex_;
+    std::condition_variable idleCondition_;
+};
+}
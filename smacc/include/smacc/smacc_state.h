@@ -5,6 +5,7 @@
  ******************************************************************************************************************/
 #pragma once
 #include "smacc/smacc_state_machine.h"
+#include "smacc/type_name.h"
 
 namespace smacc
 {
@@ -19,8 +20,6 @@ class SmaccState : public sc::simple_state<
     base_type;
 
   public:
-    ros::NodeHandle nh;
-
     //////////////////////////////////////////////////////////////////////////
     struct my_context
     {
@@ -32,88 +31,132 @@ class SmaccState : public sc::simple_state<
       typename base_type::context_ptr_type pContext_;
     };
     
+    // the node handle of this state (ie: /robot_1/RadialMotionStateMachine/StNavigate/StRotate). It is
+    // created the first time it is used, so that the states that do not use it do not create it on each entry
+    const ros::NodeHandle& getNodeHandle() const
+    {
+        if(!nh_)
+        {
+            nh_.reset(new ros::NodeHandle(base_type::outermost_context().nh.getNamespace() + "/" + getRelativeNamespace()));
+        }
+        return *nh_;
+    }
+
+    // namespace of the state relative to the state machine (ie: StNavigate/StRotate). It only depends on
+    // the state type, so it is built once
+    static const std::string& getRelativeNamespace()
+    {
+        static const std::string ns = contextRelativeNamespace<Context>(0) + rosTypeName<MostDerived>();
+        return ns;
+    }
+
     // delegates to ROS param access with the current NodeHandle
     template <typename T>
     bool getParam(std::string param_name, T& param_storage)
     {
-        return nh.getParam(param_name, param_storage);
+        return getNodeHandle().getParam(param_name, param_storage);
     }
 
     // delegates to ROS param access with the current NodeHandle
     template <typename T>
     void setParam(std::string param_name, T param_val)
     {
-        return nh.setParam(param_name, param_val);
+        return getNodeHandle().setParam(param_name, param_val);
     }
     
     // delegates to ROS param access with the current NodeHandle
     template<typename T>
     bool param(std::string param_name, T& param_val, const T& default_val) const
     {
-        return nh.param(param_name, param_val, default_val);
+        return getNodeHandle().param(param_name, param_val, default_val);
     }
   
     typedef SmaccState my_base;
 
 
     template <typename T>
-    bool getGlobalSMData(std::string name, T& ret)
+    bool getGlobalSMData(const std::string& name, T& ret)
     {
         return base_type::outermost_context().getGlobalSMData(name,ret);
     }
 
-    // store globally in this state machine. (By value parameter )
+    // store globally in this state machine (the value is copied)
     template <typename T>
-    void setGlobalSMData(std::string name, T value)
+    void setGlobalSMData(const std::string& name, const T& value)
     {
         base_type::outermost_context().setGlobalSMData(name,value);
     }
 
+    // typed global data of this state machine (see smacc::BlackboardKey)
+    Blackboard& getBlackboard()
+    {
+        return base_type::outermost_context().getBlackboard();
+    }
+
     template <typename SmaccComponentType>
-    void requiresComponent(SmaccComponentType*& storage, ros::NodeHandle nh=ros::NodeHandle())
+    void requiresComponent(SmaccComponentType*& storage)
+    {
+      base_type::outermost_context().requiresComponent(storage);
+    }
+
+    template <typename SmaccComponentType>
+    void requiresComponent(SmaccComponentType*& storage, const ros::NodeHandle& nh)
     {
       base_type::outermost_context().requiresComponent(storage,nh);
     }
 
+    // the states that require components override it to declare them, so that they are created at the
+    // state machine startup (see ComponentDeclarations)
+    static void declareComponents(ComponentDeclarations& components)
+    {
+    }
+
     SmaccState() = delete;
     
-    // constructor that initialize the state ros node handle 
+    // the node handle of the state is created on demand (see getNodeHandle)
     SmaccState( my_context ctx )
     {
       this->set_context( ctx.pContext_ );
 
-      ros::NodeHandle contextNh = optionalNodeHandle(ctx.pContext_);
-
-      ROS_DEBUG("context node handle namespace: %s", contextNh.getNamespace().c_str());
-      if(contextNh.getNamespace() == "/" )
-      {
-        contextNh = ros::NodeHandle(cleanTypeName(typeid(Context)));
-      }
-
-      std::string classname = cleanTypeName(typeid(MostDerived));
-
-      this->nh = ros::NodeHandle(contextNh.getNamespace() + std::string("/")+ classname );
-    
-      ROS_DEBUG("nodehandle namespace: %s", nh.getNamespace().c_str());
+      stateMachine_ = &base_type::outermost_context();
       this->updateCurrentState<MostDerived>(true);
 
-      this->setParam("created", true);
+      // only on the first entry of the state in this state machine: it is a call to the parameter server
+      if(!isOfflineMode() && stateMachine_->markStateEntered(StateIdOf<MostDerived>::value))
+        this->setParam("created", true);
+
+      entryTime_ = StateTimingTable::now();
       static_cast<MostDerived*>(this)->onEntry();
+      stateMachine_->getStateTimings().recordEntry(StateIdOf<MostDerived>::value, StateTimingTable::now() - entryTime_);
     }
 
     template <typename StateType>
     void updateCurrentState(bool active)
     {
-      base_type::outermost_context().updateCurrentState<StateType>(active);
+      base_type::outermost_context().template updateCurrentState<StateType>(active);
     }
 
     InnerInitial* smacc_inner_type;
+
+  private:
+    ISmaccStateMachine* stateMachine_;
+
+    mutable std::unique_ptr<ros::NodeHandle> nh_;
+
+    // steady clock nanoseconds when onEntry was called
+    uint64_t entryTime_;
+
+  public:
  
     virtual ~SmaccState() 
     {
-      ROS_ERROR("exiting state");
-      //this->updateCurrentState<MostDerived>(false);
+      ROS_DEBUG("exiting state");
+      SMACC_TRACE("state_exit/" + shortTypeName<MostDerived>());
+      stateMachine_->updateCurrentState(StateIdOf<MostDerived>::value, false);
+
+      uint64_t exitTime = StateTimingTable::now();
       static_cast<MostDerived*>(this)->onExit();
+      stateMachine_->getStateTimings().recordExit(StateIdOf<MostDerived>::value, StateTimingTable::now() - exitTime, exitTime - entryTime_);
     }
 
   public:
@@ -7,11 +7,21 @@
 
 #include <smacc/common.h>
 #include <smacc/smacc_action_client.h>
+#include <smacc/latency_histogram.h>
+#include <smacc/component_registry.h>
+#include <smacc/blackboard.h>
+#include <smacc/active_state_set.h>
+#include <smacc/state_table.h>
+#include <smacc/state_timing.h>
+#include <smacc/event_log.h>
+#include <smacc/type_name.h>
 
 #include <boost/core/demangle.hpp>
-#include <boost/any.hpp>
-#include <map>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace smacc
 {
@@ -25,88 +35,203 @@ public:
 
     virtual ~ISmaccStateMachine();
 
+    // the lookup of an existing component is lock-free and it does not allocate memory
     template <typename SmaccComponentType>
-    void requiresComponent(SmaccComponentType*& storage, ros::NodeHandle nh=ros::NodeHandle())
+    void requiresComponent(SmaccComponentType*& storage)
     {
-        std::lock_guard<std::mutex> lock(m_mutex_);
-        std::string pluginkey = boost::core::demangle(typeid(SmaccComponentType).name());
-        SmaccComponentType* ret;
-
-        auto it = plugins_.find(pluginkey);
-
-        if( it == plugins_.end())
-        {
-            ROS_INFO("%s smacc component is required. Creating a new instance.", pluginkey.c_str());
-
-            ret = new SmaccComponentType();
-            ret->init(nh);
-            ret->setStateMachine(this);
-            plugins_ [pluginkey] = static_cast<smacc::ISmaccComponent*>(ret);
-            ROS_INFO("%s resource is required. Done.", pluginkey.c_str());
-        }
-        else
+        storage = components_.template get<SmaccComponentType>();
+        if(storage == nullptr)
         {
-            ROS_INFO("%s resource is required. Found resource in cache.", pluginkey.c_str());
-            ret = dynamic_cast<SmaccComponentType*>(it->second);
+            requiresComponent(storage, ros::NodeHandle());
         }
-    
-        storage = ret;
     }
 
-    template <typename T>
-    bool getGlobalSMData(std::string name, T& ret)
+    // nh: the node handle used to initialize the component if it does not exist yet
+    template <typename SmaccComponentType>
+    void requiresComponent(SmaccComponentType*& storage, const ros::NodeHandle& nh)
     {
-        std::lock_guard<std::mutex> lock(m_mutex_);
-        ROS_WARN("get SM Data lock acquire");
-        bool success = false;
-
-        if(!globalData_.count(name))
+        storage = components_.template getOrCreate<SmaccComponentType>([&]()
         {
-            ROS_WARN("get SM Data - data do not exist");
-            success = false;
-        }
-        else
-        {
-            ROS_WARN("get SM DAta -data exist. accessing");
-            try
+            std::string pluginkey = boost::core::demangle(typeid(SmaccComponentType).name());
+            ROS_INFO("%s smacc component is required. Creating a new instance.", pluginkey.c_str());
+
+            auto ret = new SmaccComponentType();
+            ros::NodeHandle componentNh = getInstanceNodeHandle(nh);
+            if(isOfflineMode())
             {
-                boost::any v = globalData_[name];
-                ROS_WARN("get SM DAta -data exist. any cast");
-                ret = boost::any_cast<T>(v);
-                success = true;    
-                ROS_WARN("get SM DAta -data exist. success");
+                ret->initOffline(componentNh);
             }
-            catch(boost::bad_any_cast& ex)
+            else
             {
-                ROS_ERROR("bad any cast: %s", ex.what());
-                success = false;
+                int callbackThreads = getComponentCallbackThreads(rosTypeName<SmaccComponentType>());
+                if(callbackThreads > 0)
+                    ret->setDedicatedCallbackQueue(componentNh, callbackThreads);
+                ret->init(componentNh);
             }
-        }
+            ret->setStateMachine(this);
+            ret->startCallbackSpinner();
+            ROS_INFO("%s resource is required. Done.", pluginkey.c_str());
+            return ret;
+        });
+    }
 
-        ROS_WARN("get SM Data lock release");
-        return success;
+    // string-keyed access to the blackboard (compatibility layer)
+    template <typename T>
+    bool getGlobalSMData(const std::string& name, T& ret)
+    {
+        return blackboard_.get(name, ret);
     }
 
     template <typename T>
-    void setGlobalSMData(std::string name, T value)
+    void setGlobalSMData(const std::string& name, const T& value)
     {
-        std::lock_guard<std::mutex> lock(m_mutex_);
-        ROS_WARN("set SM Data lock acquire");
-        globalData_[name] = value;
+        blackboard_.set(name, value);
     }
 
+    // global data shared by the states of this state machine
+    Blackboard& getBlackboard();
+
     /// used by the ISMaccActionClients when a new send goal is launched
     void registerActionClientRequest(ISmaccActionClient* component);
 
+    SignalDetector* getSignalDetector() const;
+
+    // queues an event in the scheduler of this state machine (from any thread). The events must not be queued
+    // directly in getScheduler(): the SmaccRuntime would not know that this state machine has pending work
+    void postEvent(const boost::intrusive_ptr<const sc::event_base>& event, EventLane lane = EventLane::RESULT);
+
+    // namespace of this instance of the state machine ("" if it has not one, see SmaccRuntime::addStateMachine)
+    const std::string& getInstanceNamespace() const;
+
+    // the node handle resolved inside the namespace of this instance (ie: /move_base -> /robot_1/move_base)
+    ros::NodeHandle getInstanceNodeHandle(const ros::NodeHandle& nh) const;
+
+    // the scheduler where this state machine is hosted and its processor handle in that scheduler
+    virtual SmaccScheduler& getScheduler() const = 0;
+
+    virtual SmaccScheduler::processor_handle getProcessorHandle() const = 0;
+
+    // marks a state as active or inactive. The states call it on exit through this interface because
+    // the most derived state machine may already be destroyed
+    virtual void updateCurrentState(StateId state, bool active) = 0;
+
+    // true the first time that the state is entered in this state machine (it is called from the state
+    // machine thread)
+    bool markStateEntered(StateId state);
+
+    // flattened description of the states of this state machine
+    virtual const SmaccStateTable& getStateTable() const = 0;
+
+    // active flags of the states (indexed by StateId). They can be read from any thread without locks
+    virtual const ActiveStateSet& getActiveStates() const = 0;
+
+    // timing statistics of the states (shared by all the instances of the state machine type)
+    virtual StateTimingTable& getStateTimings() const = 0;
+
+    // latency from the creation of the smacc events (actionlib callback) until the state machine reacts to them
+    const LatencyHistogram& getEventLatencyHistogram() const;
+
+    // latency from the creation of the smacc events until the transitions they trigger are completed
+    const LatencyHistogram& getReactionLatencyHistogram() const;
+
+    // number of events that changed the active states
+    uint64_t getTransitionCount() const;
+
+    // time that the startup took to create and connect the declared components (valid once
+    // EvComponentsReady is posted)
+    ros::WallDuration getComponentStartupTime() const;
+
+    // declared components that were not ready (connected) at the end of the startup (valid once
+    // EvComponentsReady is posted)
+    int getComponentsNotReadyCount() const;
+
+    // number of spinner threads of the dedicated callback queue of a component (0: the global callback queue,
+    // spun by the signal detector). Parameters:
+    //  ~smacc_component_callback_threads (default 0)
+    //  ~smacc_components/<ComponentType>/callback_threads: overrides the default for one component type
+    int getComponentCallbackThreads(const std::string& componentName) const;
+
+protected:
+    // creates the declared components. It is called from the constructor of the state machine (the scheduler
+    // thread), so it does not wait for their connections: see startComponentsReadyWait. Parameters:
+    //  ~smacc_component_prewarm (default true)
+    //  ~smacc_component_ready_timeout: max seconds to wait for the connection of the components (default 5)
+    void prewarmComponents(const ComponentDeclarations& components);
+
+    // called once the state machine is initiated. A thread of its own waits for the connection of the
+    // prewarmed components and posts EvComponentsReady, so a scheduler shared by several state machines
+    // (SmaccRuntime) is not blocked meanwhile. In offline mode there is nothing to wait for
+    void startComponentsReadyWait();
+
+    // cancels the wait of the components. It is called from the destructor of the most derived state
+    // machine, the wait thread posts its event through it
+    void stopComponentsReadyWait();
+
+    // calls ISmaccComponent::shutdown of all the components, so their callbacks do not post events to this
+    // state machine anymore. It is called from the destructor of the most derived state machine, once the
+    // states (that may use the components on exit) are destroyed
+    void shutdownComponents();
+
+    // it is called from the state machine thread before each event is dispatched. It returns the time the
+    // event waited in the scheduler queue (nanoseconds) or -1 if it was not created by smacc
+    int64_t onEventDispatch(const sc::event_base& evt);
+
+    // it is called from the state machine thread after each event is processed
+    void onEventProcessed(const sc::event_base& evt, bool transition);
+
+    LatencyHistogram eventLatencyHistogram_;
+
+    LatencyHistogram reactionLatencyHistogram_;
+
+    std::atomic<uint64_t> transitionCount_;
+
+    // log of the dispatched events (parameter: ~smacc_event_log_file). Null if they are not recorded
+    std::unique_ptr<EventLogWriter> eventLog_;
+
+    // absolute namespace of this instance (ie: /robot_1), set by the constructor of the most derived state machine
+    std::string instanceNamespace_;
+
+    // states entered at least once (indexed by StateId, sized by the most derived state machine)
+    std::vector<bool> enteredStates_;
+
 private:
 
     std::mutex m_mutex_;
     
-    std::map<std::string, smacc::ISmaccComponent*> plugins_;
+    // one component of each type, indexed by TypeIndex<ISmaccComponent>
+    TypeIndexedRegistry<smacc::ISmaccComponent> components_;
 
-    std::map<std::string, boost::any> globalData_;
+    Blackboard blackboard_;
 
     //event to notify to the signaldetection thread that a request has been created
     SignalDetector* signalDetector_;
+
+    // prewarmed components and their ready timeout (seconds)
+    std::vector<ISmaccComponent*> prewarmedComponents_;
+    double componentReadyTimeout_;
+
+    std::thread componentsReadyThread_;
+    std::atomic<bool> componentsReadyCancelled_;
+
+    std::atomic<int64_t> componentStartupTime_;
+    std::atomic<int> componentsNotReady_;
 };
+
+template <typename ComponentType>
+ISmaccComponent* createDeclaredComponent(ISmaccStateMachine& stateMachine, const std::string& ns)
+{
+    ComponentType* component;
+    if(ns.empty())
+        stateMachine.requiresComponent(component);
+    else
+        stateMachine.requiresComponent(component, ros::NodeHandle(ns));
+
+    return component;
+}
+
+template <typename ComponentType>
+void ComponentDeclarations::add(const std::string& ns)
+{
+    add(typeid(ComponentType), ns, &createDeclaredComponent<ComponentType>);
+}
 }
\ No newline at end of file
@@ -6,6 +6,11 @@
 #pragma once
 #include <smacc/common.h>
 #include <smacc/smacc_state.h>
+#include <smacc/state_table_builder.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <type_traits>
 #include <boost/mpl/for_each.hpp>
 #include <boost/mpl/list.hpp>
@@ -13,14 +18,13 @@
 #include <smach_msgs/SmachContainerStructure.h>
 #include <smach_msgs/SmachContainerInitialStatusCmd.h>
 #include <smach_msgs/SmachContainerStatus.h>
+#include <smacc/ContainerStructures.h>
+#include <smacc/ContainerStatuses.h>
 //-------------------------------------------------------------------------------------------------
 
 namespace smacc
 {
 
-class SmaccStateMachineInfo;
-
-
 inline std::string demangleSymbol(const char* name)
 {
   #if (__GNUC__ && __cplusplus && __GNUC__ >= 3)
@@ -45,397 +49,211 @@ inline std::string demangledTypeName()
 }
 
 
-//--------------------------------
-class SmaccStateInfo: public std::enable_shared_from_this<SmaccStateInfo>
+/// State Machine
+template <typename DerivedStateMachine, typename InitialStateType>
+struct SmaccStateMachineBase : public ISmaccStateMachine,  public sc::asynchronous_state_machine<DerivedStateMachine, InitialStateType, SmaccScheduler, SmaccAllocator >
 {
 public:
-    bool active_;
-    std::string fullStateName;
-    std::string demangledStateName;
-
-    std::shared_ptr<SmaccStateMachineInfo> stateMachine_;
-    std::shared_ptr<SmaccStateInfo> parentState_;
-    std::map<std::string,std::shared_ptr<SmaccStateInfo>> transitions_;
-
-    std::vector<std::shared_ptr<SmaccStateInfo>> children_;
-    int depth_;
-
-    SmaccStateInfo(std::shared_ptr<SmaccStateInfo> parentState, std::shared_ptr<SmaccStateMachineInfo> stateMachineInfo)
-    {
-        parentState_ = parentState;
-        stateMachine_ = stateMachineInfo;
-
-        if(parentState_!=nullptr)
-            depth_ = parentState->depth_ +1;
-    }
-
-    inline int depth() const{return depth_;}
-
-
-    std::string getFullPath()
-    {
-        if( parentState_==nullptr)
-            return this->toShortName();
-        else
-            return this->parentState_->getFullPath() + "/" + this->toShortName();
-    }
-
-    template <typename StateType>
-    std::shared_ptr<SmaccStateInfo> createChildState();
-
-    template <typename EvType>
-    void declareTransition(std::shared_ptr<SmaccStateInfo>& dstState);
-
-    const std::string& toShortName() const
-    {
-        return this->demangledStateName;
-    }
-};
+    // the node handle for this state
+    ros::NodeHandle nh;
 
-//--------------------------------
-class SmaccStateMachineInfo: public std::enable_shared_from_this<SmaccStateMachineInfo>
-{
-public:
-    std::map<std::string,std::shared_ptr<SmaccStateInfo>> states;
+    ros::Timer timer_;
 
-    template <typename InitialStateType>
-    void buildStateMachineInfo();
+    // smach_viewer protocol: one message per container
+    ros::Publisher stateMachineStructurePub_;
+    ros::Publisher stateMachineStatePub_;
 
-    template <typename StateType>
-    std::shared_ptr<SmaccStateInfo> createState(std::shared_ptr<SmaccStateInfo> parentState);
+    // latched: all the containers in one message
+    ros::Publisher containerStructuresPub_;
+    ros::Publisher containerStatusesPub_;
 
     template <typename StateType>
-    bool containsState()
+    void updateCurrentState(bool active)
     {
-        auto typeNameStr = typeid(StateType).name();
-
-        return states.count(typeNameStr)>0;
+        SMACC_TRACE("state_active/" + shortTypeName<StateType>(), active);
+        updateCurrentState(StateIdOf<StateType>::value, active);
     }
 
-    template <typename StateType>
-    std::shared_ptr<SmaccStateInfo> getState()
+    virtual void updateCurrentState(StateId state, bool active) override
     {
-        if( this->containsState<StateType>())
+        if(state == NO_STATE)
         {
-            return states[typeid(StateType).name()];
+            ROS_ERROR("updated state not found in the state table");
+            return;
         }
-        return nullptr;
-    }
-
-    template <typename StateType>
-    void addState(std::shared_ptr<StateType>& state);
 
+        ROS_DEBUG_STREAM("setting state active "<< active <<": " << stateTable_.getFullPath(state));
 
-    void printAllStates()
-    {
-        for(auto& val: this->states)
+        if(activeStates_.set(state, active))
         {
-            auto state = val.second;
+            statusChanged_ = true;
 
-            std::stringstream ss;
-            if(state->parentState_== nullptr)
+            // the event latencies are accounted to the active leaf states
+            if(stateTable_.getChildren(state).empty())
             {
-                ss << "**** Print StateType: " << state->demangledStateName <<std::endl;
-                ss << " Childstates:" << std::endl;
-
-                for(auto& child: state->children_)
-                {
-                    ss << " - " << child->demangledStateName << std::endl;
-                }
-
-                ss << " Transitions:" << std::endl;
-
-                for(auto& transition: state->transitions_)
-                {
-                    ss << " - " << transition.first << " -> " << transition.second->demangledStateName << std::endl;
-                }
-
-                ROS_INFO_STREAM(ss.str());
+                if(active)
+                    activeLeaves_.push_back(state);
+                else
+                    activeLeaves_.erase(std::remove(activeLeaves_.begin(), activeLeaves_.end(), state), activeLeaves_.end());
             }
         }
     }
-};
-//--------------------------------
-
-
-template<typename T>
-struct type_
-{
-    using type= T;
-};
-
-template <typename T>
-struct add_type_wrapper
-{
-    using type = type_<T>;
-};
-//---------------------------------------------
 
-struct AddSubState
-{
-    std::shared_ptr<SmaccStateInfo>& parentState_;
-    AddSubState(std::shared_ptr<SmaccStateInfo>& parentState)
-    : parentState_(parentState)
+    // it can be called from any thread without locks
+    template <typename StateType>
+    bool isActive() const
     {
-    }
-
-    template <typename T> 
-    void operator()(T);
-};
+        static_assert(std::is_same<typename StateType::outermost_context_type, DerivedStateMachine>::value,
+                      "the state does not belong to this state machine");
 
-struct AddTransition
-{
-    std::shared_ptr<SmaccStateInfo>& currentState_;
+        StateId state = StateIdOf<StateType>::value;
+        return state != NO_STATE && activeStates_.test(state);
+    }
+  
     
-    AddTransition(std::shared_ptr<SmaccStateInfo>& currentState)
-    : currentState_(currentState)
+    SmaccStateMachineBase( my_context ctx, SignalDetector* signalDetector)
+        :ISmaccStateMachine(signalDetector),
+        sc::asynchronous_state_machine<DerivedStateMachine, InitialStateType, SmaccScheduler, SmaccAllocator >(ctx),
+        stateTable_(getStaticStateTable()),
+        stateTimings_(getStaticStateTimings())
     {
-    }
-
-    template <typename T>
-    void operator()(T);
-};
-
-template <typename InitialStateType>
-struct WalkStatesExecutor
-{
-    static void walkStates(std::shared_ptr<SmaccStateInfo>& currentState, bool rootInitialNode);
-};
+        // several instances of the same type (SmaccRuntime) are separated by their namespaces (ie: /robot_1)
+        this->instanceNamespace_ = signalDetector->getInstanceNamespace(&this->my_scheduler());
+        if(this->instanceNamespace_.empty())
+            nh = ros::NodeHandle(rosTypeName<DerivedStateMachine>());
+        else
+            nh = ros::NodeHandle(this->instanceNamespace_ + "/" + rosTypeName<DerivedStateMachine>());
 
-template <typename T> 
-void AddSubState::operator()(T)
-{
-    using type_t = typename T::type;
-    //auto childState = this->parentState_->createChildState<type_t>()
-    WalkStatesExecutor<type_t>::walkStates(parentState_, false);   
-}
-//--------------------------------------------
-template<typename T>
-typename disable_if<boost::mpl::is_sequence<T>>::type
-processSubState(std::shared_ptr<SmaccStateInfo>& parentState)
-{
-    WalkStatesExecutor<T>::walkStates(parentState, false);
-}
+        // the components declared by the states exist before the initial state is entered, EvComponentsReady
+        // is posted once they are connected (see startComponentsReadyWait)
+        prewarmComponents(stateTable_.getComponentDeclarations());
 
-template<typename T>
-typename enable_if<boost::mpl::is_sequence<T>>::type
-processSubState(std::shared_ptr<SmaccStateInfo>& parentState)
-{
-    using boost::mpl::_1;
-    using wrappedList = typename boost::mpl::transform<T,add_type_wrapper<_1>>::type;
-    boost::mpl::for_each<wrappedList>(AddSubState(parentState));
-}
-//--------------------------------------------
-template<typename T>
-typename enable_if<boost::mpl::is_sequence<T>>::type
-processTransitions(std::shared_ptr<SmaccStateInfo>& sourceState)
-{
-    using boost::mpl::_1;
-    using wrappedList = typename boost::mpl::transform<T,add_type_wrapper<_1>>::type;
-    boost::mpl::for_each<wrappedList>(AddTransition(sourceState));
-}
+        activeStates_.resize(stateTable_.size());
+        this->enteredStates_.resize(stateTable_.size());
+        updateCurrentState<InitialStateType>(true);
 
-template<typename Ev, typename Dst>
-void processTransition(statechart::transition<Ev,Dst>* , std::shared_ptr<SmaccStateInfo>& sourceState)
-{
-    //ROS_INFO_STREAM("GOTCHA");
+        // offline mode (event replay): the introspection is not published
+        if(isOfflineMode())
+            return;
 
-    if(!sourceState->stateMachine_->containsState<Dst>())
-    {
-        auto siblingnode = sourceState->stateMachine_->createState<Dst>(sourceState->parentState_);
-        WalkStatesExecutor<Dst>::walkStates(siblingnode, true);
-        sourceState->declareTransition< Ev>(siblingnode);
+        // the structure does not change at runtime: it is built only once
+        createStructureMessages(NO_STATE, structureMsgs_);
+
+        // relative to the node handle of the state machine (ie: /RadialMotionStateMachine/smach/container_structure).
+        // The smach_viewer topics carry one container per message, a latched topic would only keep the last
+        // one: the late subscribers that need all of them use the container_structures/container_statuses topics
+        stateMachineStructurePub_=nh.advertise<smach_msgs::SmachContainerStructure>("smach/container_structure",100);
+        stateMachineStatePub_ = nh.advertise<smach_msgs::SmachContainerStatus>("smach/container_status",100);
+        containerStructuresPub_ = nh.advertise<smacc::ContainerStructures>("smach/container_structures", 1, true);
+        containerStatusesPub_ = nh.advertise<smacc::ContainerStatuses>("smach/container_statuses", 1, true);
+
+        publishStructure();
+
+        // the structure does not change: the latched message is published only once
+        smacc::ContainerStructures structures;
+        structures.header.stamp = ros::Time::now();
+        structures.containers = structureMsgs_;
+        containerStructuresPub_.publish(structures);
+
+        // the status is published when the active states change. smach_viewer only learns the structure of
+        // the containers from its periodic messages: the heartbeat republishes it with the full status on its
+        // topics (0: disabled, for the systems that only use the latched topics)
+        double heartbeatPeriod;
+        nh.param("introspection_heartbeat_period", heartbeatPeriod, 1.0);
+        if(heartbeatPeriod > 0)
+            timer_= nh.createTimer(ros::Duration(heartbeatPeriod),&SmaccStateMachineBase<DerivedStateMachine,InitialStateType>::state_machine_visualization, this);
     }
-    else
+    
+    virtual ~SmaccStateMachineBase( )
     {
-        auto siblingnode = sourceState->stateMachine_->getState<Dst>();
-        sourceState->declareTransition< Ev>(siblingnode);
-    }
-}
-
-template <typename EvType>
-void SmaccStateInfo::declareTransition(std::shared_ptr<SmaccStateInfo>& dstState)
-{
-    auto evtype = demangledTypeName<EvType>();
-    transitions_[evtype] = dstState;
-}
-
-template<typename Ev>
-void processTransition(statechart::custom_reaction<Ev>* , std::shared_ptr<SmaccStateInfo>& sourceState)
-{
-    //ROS_INFO_STREAM("GOTCHA");
-}
+        timer_.stop();
+        this->stopComponentsReadyWait();
 
-template<typename T>
-typename disable_if<boost::mpl::is_sequence<T>>::type
-processTransitions(std::shared_ptr<SmaccStateInfo>& sourceState)
-{
-    //ROS_INFO_STREAM("state transition from: " << sourceState->demangledStateName << " of type: " << demangledTypeName<T>());
-    T* dummy;
-    processTransition(dummy,sourceState);
+        // the states are destroyed here (and not in the base state_machine destructor) so that
+        // they can still update the introspection info on exit
+        this->terminate();
 
+        this->shutdownComponents();
+    }
 
-}
-//--------------------------------------------
-template <typename T> 
-void AddTransition::operator()(T)
-{
-    using type_t = typename T::type;
-    processTransitions<type_t>(currentState_);
-}
+    // This function is defined in the Player.cpp
+    virtual void initiate_impl() override
+    {
+        ROS_INFO("initiate_impl");
+        sc::state_machine< DerivedStateMachine, InitialStateType, SmaccAllocator >::initiate();
+        publishStatusChanges();
+        this->startComponentsReadyWait();
+    }
 
-template <typename InitialStateType>
-  void WalkStatesExecutor<InitialStateType>::walkStates(std::shared_ptr<SmaccStateInfo>& parentState, bool rootInitialNode)
-{
-    //ros::Duration(1).sleep();
-    auto currentname = demangledTypeName<InitialStateType>();
+    virtual SmaccScheduler& getScheduler() const override
+    {
+        return this->my_scheduler();
+    }
 
-    std::shared_ptr<SmaccStateInfo> targetState;
+    virtual SmaccScheduler::processor_handle getProcessorHandle() const override
+    {
+        return this->my_handle();
+    }
 
-    if(!rootInitialNode)
+    // called from the scheduler thread for each event queued to this state machine
+    virtual void process_event_impl(const sc::event_base & evt) override
     {
-        if(parentState->stateMachine_->containsState<InitialStateType>())
+        int64_t latency = this->onEventDispatch(evt);
+        if(latency >= 0)
         {
-            // it already exist: break;
-            return;
+            for(StateId state: activeLeaves_)
+            {
+                stateTimings_.recordEventLatency(state, latency);
+            }
         }
-    
-        targetState  = parentState->createChildState<InitialStateType>();
+
+        sc::state_machine< DerivedStateMachine, InitialStateType, SmaccAllocator >::process_event(evt);
+        this->onEventProcessed(evt, statusChanged_);
+        publishStatusChanges();
     }
-    else
+
+    virtual const SmaccStateTable& getStateTable() const override
     {
-        targetState  = parentState;
+        return stateTable_;
     }
 
-    typedef typename std::remove_pointer<decltype(InitialStateType::smacc_inner_type)>::type InnerType;
-    processSubState<InnerType>(targetState);
-
-    // -------------------- REACTIONS --------------------
-    typedef typename InitialStateType::reactions reactions;
-    //ROS_INFO_STREAM("state machine initial state reactions: "<< demangledTypeName<reactions>());
-   
-    processTransitions<reactions>(targetState);
-}
-
-template <typename InitialStateType>
-void SmaccStateMachineInfo::buildStateMachineInfo()
-{
-    auto initialState = this->createState<InitialStateType>(nullptr);
-    WalkStatesExecutor<InitialStateType>::walkStates(initialState, true);
-}
-
-template <typename StateType>
-std::shared_ptr<SmaccStateInfo> SmaccStateMachineInfo::createState(std::shared_ptr<SmaccStateInfo> parent)
-{
-    auto thisptr = this->shared_from_this();
-    auto state = std::shared_ptr<SmaccStateInfo>(new SmaccStateInfo(parent, thisptr));
-    state->demangledStateName = demangledTypeName<StateType>();
-    state->fullStateName = typeid(StateType).name();
-
-    std::vector<std::string> strs;
-    boost::split(strs,state->demangledStateName,boost::is_any_of(":"));
-
-    state->demangledStateName = strs.back();
-
-    if(parent!=nullptr)
+    virtual const ActiveStateSet& getActiveStates() const override
     {
-        parent->children_.push_back(state);
+        return activeStates_;
     }
 
-    this->addState(state);
-
-    return state;
-}
-
-template <typename StateType>
-void SmaccStateMachineInfo::addState(std::shared_ptr<StateType>& state)
-{    
-    states[state->fullStateName] = state;
-}
-
-template <typename StateType>
-std::shared_ptr<SmaccStateInfo> SmaccStateInfo::createChildState()
-{
-    auto childState = this->stateMachine_->createState<StateType>(shared_from_this());
-    //this->stateMachine_->addState(childState);
-    //stateMachineInfo.addState(stateMachineInfo)
-    //stateNames.push_back(currentname);
-    //ROS_INFO("------------");
-    //ROS_INFO_STREAM("** STATE state: "<< this->demangledStateName);
-
-    return childState;
-}
-
-
-/// State Machine
-template <typename DerivedStateMachine, typename InitialStateType>
-struct SmaccStateMachineBase : public ISmaccStateMachine,  public sc::asynchronous_state_machine<DerivedStateMachine, InitialStateType, SmaccScheduler, SmaccAllocator >
-{
-public:
-    // the node handle for this state
-    ros::NodeHandle nh;
-    std::shared_ptr<SmaccStateMachineInfo> info_;
-
-    ros::Timer timer_;
-    ros::Publisher stateMachineStructurePub_;
-    ros::Publisher stateMachineStatePub_;
-
-    //std::vector<std::shared_ptr<SmaccStateInfo>> currentState_;
-
-    template <typename StateType>
-    void updateCurrentState(bool active)
+    virtual StateTimingTable& getStateTimings() const override
     {
-        auto a =  info_->getState<StateType>();
+        return stateTimings_;
+    }
 
-        if(a!=nullptr)
-        {
-                ROS_WARN_STREAM("setting state active "<< active <<": " << a->getFullPath());
-                a->active_ = active;
-        }
-        else
+    // the state table only depends on the state machine type: it is built once and shared by all its instances
+    static const SmaccStateTable& getStaticStateTable()
+    {
+        static const SmaccStateTable table = []()
         {
-            ROS_ERROR_STREAM("updated state not found: " <<typeid(StateType).name());
-        }  
+            SmaccStateTable table;
+            buildStateTable<InitialStateType>(table);
+            table.printAllStates();
+            return table;
+        }();
 
-        
-        /*  
-        if(a !=nullptr && a->parentState_==nullptr)
-        {
-            currentState_ =a;
-            ROS_ERROR("really updated");
-        }*/
+        return table;
     }
-  
-    
-    SmaccStateMachineBase( my_context ctx, SignalDetector* signalDetector)
-        :ISmaccStateMachine(signalDetector),
-        sc::asynchronous_state_machine<DerivedStateMachine, InitialStateType, SmaccScheduler, SmaccAllocator >(ctx)
-    {
-        nh = ros::NodeHandle(cleanTypeName(typeid(DerivedStateMachine)));
-
-        info_ = std::make_shared<SmaccStateMachineInfo>();
-        info_->buildStateMachineInfo<InitialStateType>();
-        updateCurrentState<InitialStateType>(true);
-        
-        info_->printAllStates();
 
-          
-        timer_= nh.createTimer(ros::Duration(0.1),&SmaccStateMachineBase<DerivedStateMachine,InitialStateType>::state_machine_visualization, this);
-        stateMachineStructurePub_=nh.advertise<smach_msgs::SmachContainerStructure>("/RadialMotionStateMachine/smach/container_structure",1);
-        stateMachineStatePub_ = nh.advertise<smach_msgs::SmachContainerStatus>("/RadialMotionStateMachine/smach/container_status",1);     
-    
-    }
-    
-    virtual ~SmaccStateMachineBase( )
+    static StateTimingTable& getStaticStateTimings()
     {
-        //updateCurrentState<InitialStateType>(false);
+        static StateTimingTable timings(getStaticStateTable(), shortTypeName<DerivedStateMachine>());
+        return timings;
     }
 
-    // This function is defined in the Player.cpp
-    virtual void initiate_impl() override
+    // publishes the status of the containers whose active states changed since the last publication
+    void publishStatusChanges()
     {
-        ROS_INFO("initiate_impl");
-        sc::state_machine< DerivedStateMachine, InitialStateType, SmaccAllocator >::initiate();
+        if(statusChanged_.exchange(false) && stateMachineStatePub_)
+        {
+            publishStatus(false);
+        }
     }
 
      // delegates to ROS param access with the current NodeHandle
@@ -459,154 +277,146 @@ public:
         return nh.param(param_name, param_val, default_val);
     }
 
-    void createStructureMessage(std::shared_ptr<SmaccStateInfo> container, std::string currentPath, std::vector<smach_msgs::SmachContainerStructure>& structure_msgs, int deep)
+    // path of a container in the introspection messages
+    std::string getContainerPath(StateId container) const
     {
-        if(deep ==0)
-        {
-            return;
-        }
+        static const std::string root = "/" + rosTypeName<DerivedStateMachine>();
+        if(container == NO_STATE)
+            return root;
+        else
+            return root + "/" + stateTable_.getFullPath(container);
+    }
 
+    // structure of the container and (recursively) of all its substates
+    void createStructureMessages(StateId container, std::vector<smach_msgs::SmachContainerStructure>& structure_msgs)
+    {
         smach_msgs::SmachContainerStructure structure_msg;
-        structure_msg.header.stamp = ros::Time::now();
+        structure_msg.path = getContainerPath(container);
 
-        std::string currentpathprefix;
-        
-        // ROOT STATE
-        if(container==nullptr)
-        {
-            // THE NAME OF THE STATE MACHINE WITH A PREFIX '/' CHARACTER
-            currentpathprefix = "/" + currentPath;
-            structure_msg.path= currentpathprefix;
-        }
-        else // IT IS A SUBSTATE
+        auto children = stateTable_.getChildren(container);
+        for(StateId state: children)
         {
-            if(currentPath!="")
-                currentpathprefix = currentPath + "/"  ;
-            else
-                currentpathprefix = "/";
+            auto& stateName = stateTable_.getShortName(state);
+            structure_msg.children.push_back(stateName);    
 
-            structure_msg.path = currentpathprefix + container->demangledStateName;
-        }
+            for(auto& transition: stateTable_.getTransitions(state))
+            {
+                structure_msg.internal_outcomes.push_back("success");
+                structure_msg.outcomes_to.push_back(stateTable_.getShortName(transition.target));
+                structure_msg.outcomes_from.push_back(stateName);
+            }
 
-        static int i =0;
-        for(auto& val: info_->states)
-        {
-            // childstate
-            auto state = val.second;
-            std::stringstream ss;
-            if(state->parentState_== container)
+            if(container != NO_STATE)
             {
-                structure_msg.children.push_back(state->toShortName());    
-
-                for(auto& transition: state->transitions_)
-                {
-                    structure_msg.internal_outcomes.push_back("success");//transition.first);  
-                    structure_msg.outcomes_to.push_back(transition.second->toShortName());
-                    structure_msg.outcomes_from.push_back(state->toShortName());
-                }
-
-                if(state->parentState_!=nullptr)
-                {
-                    structure_msg.outcomes_to.push_back("success");
-                    structure_msg.outcomes_from.push_back(state->toShortName());
-                    structure_msg.container_outcomes.push_back("success");
-                }
-                /*
-                if(state->transitions_.size() > 0)
-                    structure_msg.container_outcomes.push_back(state->transitions_.begin()->first); 
-                else if( state->parentState_!=nullptr && state->parentState_->transitions_.size()>0)
-                    structure_msg.container_outcomes.push_back(state->parentState_->transitions_.begin()->first); 
-
-                */
-                
-                createStructureMessage(state, structure_msg.path, structure_msgs, deep -1);
+                structure_msg.outcomes_to.push_back("success");
+                structure_msg.outcomes_from.push_back(stateName);
+                structure_msg.container_outcomes.push_back("success");
             }
         }
 
         structure_msgs.push_back(structure_msg);
+
+        for(StateId state: children)
+        {
+            createStructureMessages(state, structure_msgs);
+        }
     }
 
-    void recursivePublishStatus(std::shared_ptr<SmaccStateInfo> parentstate)
+    // status of the container and (recursively) of its active substates
+    // active: snapshot of the active flags (ActiveStateSet::snapshot)
+    void createStatusMessages(StateId container, const std::vector<uint64_t>& active, std::vector<smach_msgs::SmachContainerStatus>& status_msgs)
     {
-        //ROS_WARN_STREAM("*" + parentstate->toShortName());
+        auto isActive = [&](StateId state) { return (active[state >> 6] >> (state & 63)) & 1; };
+
         smach_msgs::SmachContainerStatus status_msg;
-        status_msg.header.stamp = ros::Time::now();
+        status_msg.path = getContainerPath(container);
 
-        if(parentstate==nullptr)
+        auto children = stateTable_.getChildren(container);
+        for(StateId state: children)
         {
-            status_msg.path = "/RadialMotion";
-
-            for(auto& val: info_->states)
+            if(isActive(state))
             {
-                auto state = val.second;
-
-                if(state->parentState_!=nullptr // only root elements
-                    || !state->active_ )
-                        continue;     
-
-                //ROS_WARN_STREAM("active root state: " << state->toShortName());
-                status_msg.active_states.push_back(state->toShortName());
+                status_msg.active_states.push_back(stateTable_.getShortName(state));
             }
+        }
 
-            status_msg.info = "HEART BEAT";
+        status_msg.info = "HEART BEAT";
     
-            status_msg.local_data.resize(6);
-            status_msg.local_data[0] = 0x80;
-            status_msg.local_data[1] = 0x02;
-            status_msg.local_data[2] = 0x7d;
-            status_msg.local_data[3] = 0x71;
-            status_msg.local_data[4] = 0x00;
-            status_msg.local_data[5] = 0x2e;
+        status_msg.local_data.resize(6);
+        status_msg.local_data[0] = 0x80;
+        status_msg.local_data[1] = 0x02;
+        status_msg.local_data[2] = 0x7d;
+        status_msg.local_data[3] = 0x71;
+        status_msg.local_data[4] = 0x00;
+        status_msg.local_data[5] = 0x2e;
 
-            stateMachineStatePub_.publish(status_msg);
+        status_msgs.push_back(status_msg);
 
-            for(auto& val: info_->states)
+        for(StateId state: children)
+        {
+            if(isActive(state) && !stateTable_.getChildren(state).empty())
             {
-                auto state = val.second;
+                createStatusMessages(state, active, status_msgs);
+            }
+        }
+    }
 
-                if(state->parentState_!=nullptr // only root elements
-                    || !state->active_ )
-                        continue;     
+    // publishes the status of the active containers. If force is false only the containers whose
+    // active states differ from the last published ones are published on the smach_viewer topic.
+    // The container_statuses topic receives all the active containers when some of them changed
+    void publishStatus(bool force)
+    {
+        std::lock_guard<std::mutex> lock(introspectionMutex_);
 
-                recursivePublishStatus(state);
-            }
+        // consistent copy of the active states (the state machine thread may be changing them)
+        std::vector<uint64_t> active;
+        activeStates_.snapshot(active);
 
+        std::vector<smach_msgs::SmachContainerStatus> status_msgs;
+        createStatusMessages(NO_STATE, active, status_msgs);
 
-        }
-        else
+        // the containers that are not active anymore are forgotten, so that they are published again
+        // when they are reentered
+        std::map<std::string, std::vector<std::string>> publishedStatus;
+        auto stamp = ros::Time::now();
+        bool changed = publishedStatus_.size() != status_msgs.size();
+
+        for(auto& status_msg: status_msgs)
         {
-            status_msg.path = "/RadialMotion/"+ parentstate->getFullPath();
+            status_msg.header.stamp = stamp;
 
-            //status_msg.initial_states.push_back("NavigateToRadialStart");
-            for(auto& child: parentstate->children_)
+            auto previous = publishedStatus_.find(status_msg.path);
+            if(previous == publishedStatus_.end() || previous->second != status_msg.active_states)
+            {
+                changed = true;
+                stateMachineStatePub_.publish(status_msg);
+            }
+            else if(force)
             {
-                if(child->active_)
-                {
-                    //ROS_WARN_STREAM("active child state ("<< parentstate->toShortName()<<"): " << child->toShortName());
-                    status_msg.active_states.push_back(child->toShortName());
-                }
+                stateMachineStatePub_.publish(status_msg);
             }
 
-             status_msg.info = "HEART BEAT";
-        
-            status_msg.local_data.resize(6);
-            status_msg.local_data[0] = 0x80;
-            status_msg.local_data[1] = 0x02;
-            status_msg.local_data[2] = 0x7d;
-            status_msg.local_data[3] = 0x71;
-            status_msg.local_data[4] = 0x00;
-            status_msg.local_data[5] = 0x2e;
+            publishedStatus[status_msg.path] = status_msg.active_states;
+        }
 
+        publishedStatus_.swap(publishedStatus);
 
-            stateMachineStatePub_.publish(status_msg);
+        if(changed)
+        {
+            smacc::ContainerStatuses statuses;
+            statuses.header.stamp = stamp;
+            statuses.containers = std::move(status_msgs);
+            containerStatusesPub_.publish(statuses);
+        }
+    }
 
-            for(auto& child: parentstate->children_)
-            {
-                if(child->active_ && !child->children_.empty())
-                {
-                    recursivePublishStatus(child);
-                }
-            }
+    void publishStructure()
+    {
+        auto stamp = ros::Time::now();
+        for(auto& structure_msg: structureMsgs_)
+        {
+            structure_msg.header.stamp = stamp;
+            stateMachineStructurePub_.publish(structure_msg);
         }
     }
 
@@ -627,76 +437,10 @@ public:
     container_outcomes: [outcome4, outcome5]
     */
 
-    std::vector<smach_msgs::SmachContainerStructure> structure_msgs;
-    createStructureMessage(nullptr, "RadialMotion", structure_msgs,-1);
-
-    /*
-    structure_msg.children.push_back("NavigateToEndPoint");
-    structure_msg.children.push_back("NavigateToRadialStart");
-    structure_msg.children.push_back("ReturnToRadialStart");
-    structure_msg.children.push_back("RotateDegress");         
-    */
-
-    /*
-    structure_msg.container_outcomes.push_back("ev1");
-    structure_msg.container_outcomes.push_back("ev2");
-    structure_msg.container_outcomes.push_back("ev3");
-    structure_msg.container_outcomes.push_back("ev4");
-    */
-    
-    /*structure_msg.internal_outcomes.push_back("ev1");
-    structure_msg.internal_outcomes.push_back("ev2");
-    structure_msg.internal_outcomes.push_back("ev2");
-    structure_msg.internal_outcomes.push_back("ev2");
-
-    structure_msg.outcomes_from.push_back("NavigateToEndPoint");
-    structure_msg.outcomes_from.push_back("NavigateToRadialStart");
-    structure_msg.outcomes_from.push_back("ReturnToRadialStart");
-    structure_msg.outcomes_from.push_back("RotateDegress");
-
-    structure_msg.outcomes_to.push_back("ReturnToRadialStart");
-    structure_msg.outcomes_to.push_back("NavigateToEndPoint");
-    structure_msg.outcomes_to.push_back("RotateDegress");
-    structure_msg.outcomes_to.push_back("NavigateToEndPoint");
-*/
-    for(int i= structure_msgs.size() -1 ; i >= 0 ; i--)
-    {
-        for(auto& structure_msg: structure_msgs)
-        {
-            stateMachineStructurePub_.publish(structure_msgs[i]);
-        }
-    }
-
-    
-    //ROS_WARN("status");
-    recursivePublishStatus(nullptr);
-    
-
-    /*    
-    if(currentState_ !=nullptr && currentState_->parentState_==nullptr)
-    {        
-        smach_msgs::SmachContainerStatus status_msg;
-        status_msg.header.stamp = ros::Time::now();
-
-        status_msg.path = "/RadialMotion";
-        status_msg.initial_states.push_back("NavigateToRadialStart");
-        status_msg.active_states.push_back(currentState_->toShortName());
-        status_msg.info = "HEART BEAT";
-        
-        status_msg.local_data.resize(6);
-        status_msg.local_data[0] = 0x80;
-        status_msg.local_data[1] = 0x02;
-        status_msg.local_data[2] = 0x7d;
-        status_msg.local_data[3] =  0x71;
-        status_msg.local_data[4] = 0x00;
-        status_msg.local_data[5] = 0x2e;
-
-
-        stateMachineStatePub_.publish(status_msg);
-    }*/
-
-//
-
+        // heartbeat for smach_viewer: the structure of all the containers and the full status are republished
+        // on its topics
+        publishStructure();
+        publishStatus(true);
 
     /*
     ---
@@ -713,7 +457,28 @@ public:
     gAJ9cQAu
     info: "HEART BEAT"
     */
-    
-}      
+    }
+
+private:
+    const SmaccStateTable& stateTable_;
+
+    ActiveStateSet activeStates_;
+
+    // active states without substates (only used from the state machine thread)
+    std::vector<StateId> activeLeaves_;
+
+    StateTimingTable& stateTimings_;
+
+    // cached structure of the state machine (built in the constructor)
+    std::vector<smach_msgs::SmachContainerStructure> structureMsgs_;
+
+    // active states of each container in the last status publication
+    std::map<std::string, std::vector<std::string>> publishedStatus_;
+
+    // set by updateCurrentState when the active states change
+    std::atomic<bool> statusChanged_{false};
+
+    // guards publishedStatus_ (the heartbeat runs in other thread)
+    std::mutex introspectionMutex_;
 };
 }
\ No newline at end of file
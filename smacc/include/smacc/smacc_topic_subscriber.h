@@ -0,0 +1,202 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/component.h>
+#include <smacc/signal_detector.h>
+#include <atomic>
+#include <mutex>
+
+namespace smacc
+{
+// Non template part of the topic subscriber components: filtering counters, rate limit and event lane
+class ISmaccTopicSubscriber: public ISmaccComponent
+{
+public:
+    ISmaccTopicSubscriber();
+
+    virtual ~ISmaccTopicSubscriber();
+
+    virtual void init(ros::NodeHandle& nh) override;
+
+    virtual void initOffline(ros::NodeHandle& nh) override;
+
+    // the subscription is closed: processMessage is not called anymore
+    virtual void shutdown() override;
+
+    // at most one event each 1/hz seconds, the messages received meanwhile are discarded (0: no limit)
+    void setMaxRate(double hz);
+
+    // if enabled, there is at most one event of this subscriber queued in the scheduler. The messages received
+    // while it waits replace its message, so the state machine only sees the newest one
+    void setLatestOnly(bool latestOnly);
+
+    // lane of the scheduler where the events are queued (default: FEEDBACK)
+    void setEventLane(EventLane lane);
+
+    // the topic of the subscription (empty until subscribe is called)
+    const std::string& getTopic() const;
+
+    unsigned long getReceivedCount() const;
+
+    // messages discarded by the predicate
+    unsigned long getFilteredCount() const;
+
+    // messages discarded by the rate limit
+    unsigned long getThrottledCount() const;
+
+    // messages that replaced the message of an event that was still queued (latest-only)
+    unsigned long getCoalescedCount() const;
+
+    // events queued in the scheduler
+    unsigned long getPostedCount() const;
+
+protected:
+    // called from the callback thread, mutex_ must be locked. Returns false if the message has to be
+    // discarded because of the rate limit
+    bool checkRate();
+
+    // called from the state machine thread when an event of this subscriber is going to be dispatched
+    virtual void onEventDispatch(const ITopicMessageEvent* event) = 0;
+
+    ros::NodeHandle nh_;
+    std::string topic_;
+    ros::Subscriber subscriber_;
+
+    std::mutex mutex_;
+    ros::WallDuration minPeriod_;
+    ros::WallTime lastPostTime_;
+    bool latestOnly_;
+    EventLane lane_;
+
+    std::atomic<unsigned long> receivedCount_;
+    std::atomic<unsigned long> filteredCount_;
+    std::atomic<unsigned long> throttledCount_;
+    std::atomic<unsigned long> coalescedCount_;
+    std::atomic<unsigned long> postedCount_;
+
+    friend struct ITopicMessageEvent;
+};
+
+// Component that converts the messages of a topic into EvTopicMessage<MessageType> events. The messages are
+// filtered in the subscriber callback thread (the global callback queue or the dedicated queue of the
+// component), so only the messages that matter reach the state machine thread:
+//
+//     void onEntry()
+//     {
+//         this->requiresComponent(laserSubscriber_);
+//         laserSubscriber_->setPredicate([](const sensor_msgs::LaserScan& scan) { return minRange(scan) < 0.5; });
+//         laserSubscriber_->setMaxRate(5);
+//         laserSubscriber_->subscribe("/scan");
+//     }
+//
+//     typedef sc::custom_reaction<smacc::EvTopicMessage<sensor_msgs::LaserScan>> reactions;
+//
+// The order is: predicate, rate limit, latest-only coalescing. There is one component of each type in the
+// state machine: derive from SmaccTopicSubscriber<MessageType> to subscribe to several topics of the same type
+template <typename MessageType>
+class SmaccTopicSubscriber: public ISmaccTopicSubscriber
+{
+public:
+    typedef boost::shared_ptr<const MessageType> MessageConstPtr;
+    typedef boost::function<bool(const MessageType&)> Predicate;
+
+    SmaccTopicSubscriber()
+    {
+    }
+
+    virtual ~SmaccTopicSubscriber()
+    {
+    }
+
+    // topic: relative to the node handle of the component. In offline mode there is no subscription
+    void subscribe(const std::string& topic, uint32_t queueSize = 1)
+    {
+        topic_ = topic;
+        if(isOfflineMode())
+            return;
+
+        subscriber_ = nh_.subscribe(topic, queueSize, &SmaccTopicSubscriber<MessageType>::processMessage, this);
+    }
+
+    void unsubscribe()
+    {
+        subscriber_.shutdown();
+    }
+
+    // only the messages that fulfil the predicate are posted (empty: all of them). It is called from the callback thread
+    void setPredicate(const Predicate& predicate)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        predicate_ = predicate;
+    }
+
+    // subscriber callback. It can be called directly to inject messages (ie: from another component)
+    void processMessage(const MessageConstPtr& message)
+    {
+        receivedCount_.fetch_add(1, std::memory_order_relaxed);
+
+        boost::intrusive_ptr<EvTopicMessage<MessageType>> event;
+        EventLane lane;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(predicate_ && !predicate_(*message))
+            {
+                filteredCount_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if(!checkRate())
+            {
+                throttledCount_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if(queuedEvent_ && queuedEvent_->ref_count() == 1)
+            {
+                // the scheduler discarded it (overflow policy of the lane), it will never be dispatched
+                queuedEvent_.reset();
+            }
+
+            if(queuedEvent_)
+            {
+                // the queued event is not dispatched yet (see onEventDispatch): it takes the newest message
+                queuedEvent_->message = message;
+                coalescedCount_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            event = new EvTopicMessage<MessageType>();
+            event->subscriber = this;
+            event->message = message;
+
+            if(latestOnly_)
+                queuedEvent_ = event;
+
+            // setEventLane may change it once the mutex is released
+            lane = lane_;
+        }
+
+        postedCount_.fetch_add(1, std::memory_order_relaxed);
+        stateMachine_->getSignalDetector()->postEvent(stateMachine_, event, lane);
+    }
+
+protected:
+    virtual void onEventDispatch(const ITopicMessageEvent* event) override
+    {
+        // from now on the message of the event is read by the states, it must not be replaced
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(queuedEvent_.get() == event)
+            queuedEvent_.reset();
+    }
+
+private:
+    Predicate predicate_;
+
+    // latest-only: the event of this subscriber that is queued in the scheduler (protected by mutex_)
+    boost::intrusive_ptr<EvTopicMessage<MessageType>> queuedEvent_;
+};
+}
@@ -0,0 +1,161 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/component_declarations.h>
+
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace smacc
+{
+// dense index of a state in its SmaccStateTable
+typedef int StateId;
+
+const StateId NO_STATE = -1;
+
+// contiguous range of elements of a SmaccStateTable
+template <typename T>
+struct TableRange
+{
+    const T* first;
+    const T* last;
+
+    const T* begin() const
+    {
+        return first;
+    }
+
+    const T* end() const
+    {
+        return last;
+    }
+
+    std::size_t size() const
+    {
+        return last - first;
+    }
+
+    bool empty() const
+    {
+        return first == last;
+    }
+};
+
+// Flattened description of the states of a state machine (structure of arrays indexed by StateId).
+// It is filled once with addState/addTransition, then build() computes the children of each state
+// (CSR ranges), the sorted transitions and the full paths. After build() it is read only.
+class SmaccStateTable
+{
+public:
+    struct Transition
+    {
+        // demangled name of the event type
+        std::string event;
+        StateId target;
+    };
+
+    SmaccStateTable();
+
+    // shortName: the state type name without namespaces
+    StateId addState(const std::type_info& stateType, const std::string& shortName, StateId parent);
+
+    // if the source state already has a transition for this event, it is replaced
+    void addTransition(StateId source, const std::string& event, StateId target);
+
+    void build();
+
+    int size() const
+    {
+        return parents_.size();
+    }
+
+    // returns NO_STATE if the state type is not part of the state machine
+    StateId find(const std::type_info& stateType) const;
+
+    template <typename StateType>
+    StateId find() const
+    {
+        return find(typeid(StateType));
+    }
+
+    StateId getParent(StateId state) const
+    {
+        return parents_[state];
+    }
+
+    int getDepth(StateId state) const
+    {
+        return depths_[state];
+    }
+
+    const std::string& getShortName(StateId state) const
+    {
+        return shortNames_[state];
+    }
+
+    // names of the state and its ancestors separated by '/' (ie: "Parent/Child")
+    const std::string& getFullPath(StateId state) const
+    {
+        return fullPaths_[state];
+    }
+
+    // children of the state. The children of NO_STATE are the root states
+    TableRange<StateId> getChildren(StateId state) const;
+
+    // outgoing transitions of the state sorted by event name
+    TableRange<Transition> getTransitions(StateId state) const;
+
+    void printAllStates() const;
+
+    // components declared by the states (declareComponents)
+    ComponentDeclarations& getComponentDeclarations()
+    {
+        return componentDeclarations_;
+    }
+
+    const ComponentDeclarations& getComponentDeclarations() const
+    {
+        return componentDeclarations_;
+    }
+
+private:
+    std::unordered_map<std::type_index, StateId> ids_;
+
+    std::vector<std::string> shortNames_;
+    std::vector<std::string> fullPaths_;
+    std::vector<StateId> parents_;
+    std::vector<int> depths_;
+
+    // children of state i: children_[childOffsets_[i + 1], childOffsets_[i + 2]) (slot 0 is NO_STATE)
+    std::vector<int> childOffsets_;
+    std::vector<StateId> children_;
+
+    // transitions of state i: transitions_[transitionOffsets_[i], transitionOffsets_[i + 1])
+    std::vector<int> transitionOffsets_;
+    std::vector<Transition> transitions_;
+
+    // transitions of each state before build()
+    std::vector<std::pair<StateId, Transition>> pendingTransitions_;
+
+    ComponentDeclarations componentDeclarations_;
+};
+
+// Dense id of a state type in the table of its state machine. It is assigned when the table is built
+// (the state machine constructor), so the state machine finds its states without lookups. The ids do
+// not depend on the table instance: the walk of a state machine type always produces the same ids.
+template <typename StateType>
+struct StateIdOf
+{
+    static StateId value;
+};
+
+template <typename StateType>
+StateId StateIdOf<StateType>::value = NO_STATE;
+}
@@ -0,0 +1,182 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+#include <smacc/state_table.h>
+#include <smacc/type_name.h>
+#include <type_traits>
+#include <boost/mpl/for_each.hpp>
+#include <boost/mpl/is_sequence.hpp>
+#include <boost/mpl/placeholders.hpp>
+#include <boost/mpl/transform.hpp>
+#include <boost/statechart/custom_reaction.hpp>
+#include <boost/statechart/transition.hpp>
+#include <boost/utility/enable_if.hpp>
+
+// Builds the SmaccStateTable of a state machine from the inner states and the reactions of its states.
+// The traversal code is generated by the templates for each state type and the names of the states and
+// events are generated by the compiler (type_name.h), so no demangling is done.
+namespace smacc
+{
+template<typename T>
+struct type_
+{
+    using type= T;
+};
+
+template <typename T>
+struct add_type_wrapper
+{
+    using type = type_<T>;
+};
+//---------------------------------------------
+
+struct AddSubState
+{
+    SmaccStateTable& table_;
+    StateId parentState_;
+
+    AddSubState(SmaccStateTable& table, StateId parentState)
+    : table_(table), parentState_(parentState)
+    {
+    }
+
+    template <typename T> 
+    void operator()(T);
+};
+
+struct AddTransition
+{
+    SmaccStateTable& table_;
+    StateId currentState_;
+    
+    AddTransition(SmaccStateTable& table, StateId currentState)
+    : table_(table), currentState_(currentState)
+    {
+    }
+
+    template <typename T>
+    void operator()(T);
+};
+
+template <typename InitialStateType>
+struct WalkStatesExecutor
+{
+    static void walkStates(SmaccStateTable& table, StateId currentState, bool rootInitialNode);
+};
+
+template <typename StateType>
+StateId createState(SmaccStateTable& table, StateId parentState)
+{
+    StateIdOf<StateType>::value = table.addState(typeid(StateType), shortTypeName<StateType>(), parentState);
+    return StateIdOf<StateType>::value;
+}
+
+template <typename T> 
+void AddSubState::operator()(T)
+{
+    using type_t = typename T::type;
+    WalkStatesExecutor<type_t>::walkStates(table_, parentState_, false);   
+}
+//--------------------------------------------
+template<typename T>
+typename boost::disable_if<boost::mpl::is_sequence<T>>::type
+processSubState(SmaccStateTable& table, StateId parentState)
+{
+    WalkStatesExecutor<T>::walkStates(table, parentState, false);
+}
+
+template<typename T>
+typename boost::enable_if<boost::mpl::is_sequence<T>>::type
+processSubState(SmaccStateTable& table, StateId parentState)
+{
+    using boost::mpl::_1;
+    using wrappedList = typename boost::mpl::transform<T,add_type_wrapper<_1>>::type;
+    boost::mpl::for_each<wrappedList>(AddSubState(table, parentState));
+}
+//--------------------------------------------
+template<typename T>
+typename boost::enable_if<boost::mpl::is_sequence<T>>::type
+processTransitions(SmaccStateTable& table, StateId sourceState)
+{
+    using boost::mpl::_1;
+    using wrappedList = typename boost::mpl::transform<T,add_type_wrapper<_1>>::type;
+    boost::mpl::for_each<wrappedList>(AddTransition(table, sourceState));
+}
+
+template<typename Ev, typename Dst>
+void processTransition(boost::statechart::transition<Ev,Dst>* , SmaccStateTable& table, StateId sourceState)
+{
+    auto siblingnode = table.find<Dst>();
+    if(siblingnode == NO_STATE)
+    {
+        siblingnode = createState<Dst>(table, table.getParent(sourceState));
+        WalkStatesExecutor<Dst>::walkStates(table, siblingnode, true);
+    }
+
+    table.addTransition(sourceState, typeName<Ev>(), siblingnode);
+}
+
+template<typename Ev>
+void processTransition(boost::statechart::custom_reaction<Ev>* , SmaccStateTable& table, StateId sourceState)
+{
+}
+
+template<typename T>
+typename boost::disable_if<boost::mpl::is_sequence<T>>::type
+processTransitions(SmaccStateTable& table, StateId sourceState)
+{
+    T* dummy = nullptr;
+    processTransition(dummy, table, sourceState);
+}
+//--------------------------------------------
+template <typename T> 
+void AddTransition::operator()(T)
+{
+    using type_t = typename T::type;
+    processTransitions<type_t>(table_, currentState_);
+}
+
+template <typename InitialStateType>
+  void WalkStatesExecutor<InitialStateType>::walkStates(SmaccStateTable& table, StateId parentState, bool rootInitialNode)
+{
+    StateId targetState;
+
+    if(!rootInitialNode)
+    {
+        if(table.find<InitialStateType>() != NO_STATE)
+        {
+            // it already exist: break;
+            return;
+        }
+    
+        targetState = createState<InitialStateType>(table, parentState);
+    }
+    else
+    {
+        targetState = parentState;
+    }
+
+    typedef typename std::remove_pointer<decltype(InitialStateType::smacc_inner_type)>::type InnerType;
+    processSubState<InnerType>(table, targetState);
+
+    // -------------------- REACTIONS --------------------
+    typedef typename InitialStateType::reactions reactions;
+   
+    processTransitions<reactions>(table, targetState);
+
+    // -------------------- COMPONENTS --------------------
+    InitialStateType::declareComponents(table.getComponentDeclarations());
+}
+
+// fills the table with all the states reachable from the initial state (inner states and transitions)
+template <typename InitialStateType>
+void buildStateTable(SmaccStateTable& table)
+{
+    auto initialState = createState<InitialStateType>(table, NO_STATE);
+    WalkStatesExecutor<InitialStateType>::walkStates(table, initialState, true);
+    table.build();
+}
+}
@@ -0,0 +1,92 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <smacc/latency_histogram.h>
+#include <smacc/state_table.h>
+#include <smacc/StateTimings.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace smacc
+{
+// timing statistics of one state type (nanoseconds)
+struct StateTimingStats
+{
+    StateTimingStats()
+        : entries(0)
+    {
+    }
+
+    std::atomic<uint64_t> entries;
+
+    // duration of the onEntry and onExit methods
+    LatencyHistogram onEntry;
+    LatencyHistogram onExit;
+
+    // time from the construction to the destruction of the state
+    LatencyHistogram dwell;
+
+    // time that the events waited in the scheduler queue (from queued to dispatched) while the state was
+    // active (leaf states)
+    LatencyHistogram eventLatency;
+};
+
+// Timing statistics of the states of a state machine type. It is shared by all the instances of the
+// state machine type and it can be written and read from any thread without locks. The statistics of
+// each state are created the first time the state is entered.
+class StateTimingTable
+{
+public:
+    StateTimingTable(const SmaccStateTable& stateTable, const std::string& stateMachineName);
+
+    ~StateTimingTable();
+
+    StateTimingTable(const StateTimingTable&) = delete;
+    StateTimingTable& operator=(const StateTimingTable&) = delete;
+
+    static uint64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void recordEntry(StateId state, uint64_t onEntryNanoseconds);
+
+    void recordExit(StateId state, uint64_t onExitNanoseconds, uint64_t dwellNanoseconds);
+
+    void recordEventLatency(StateId state, uint64_t nanoseconds);
+
+    // returns nullptr if the state was never entered (or it is not in the state table)
+    const StateTimingStats* find(StateId state) const;
+
+    const SmaccStateTable& getStateTable() const;
+
+    const std::string& getStateMachineName() const;
+
+    void toMsg(smacc::StateTimings& msg) const;
+
+    void toString(std::stringstream& ss) const;
+
+    // one line per entered state: state machine, state, entries and [mean, p50, p99, max] of each measure
+    void toCsv(std::ostream& out) const;
+
+    static void csvHeader(std::ostream& out);
+
+private:
+    // false for NO_STATE: the record* methods ignore those states
+    bool isValid(StateId state) const;
+
+    StateTimingStats& getOrCreate(StateId state);
+
+    const SmaccStateTable& stateTable_;
+    std::string stateMachineName_;
+    std::unique_ptr<std::atomic<StateTimingStats*>[]> stats_;
+};
+}
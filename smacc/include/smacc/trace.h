@@ -0,0 +1,155 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Binary tracing of the hot paths of smacc and its plugins.
+//
+//     SMACC_TRACE("backward_local_planner/cmd_vel", vetta, gamma);
+//
+// Each call writes a fixed size record (timestamp, thread, event id and up to 6 numeric arguments)
+// into a lock-free ring buffer of the calling thread. The name is only evaluated the first time.
+// smacc::trace::dump() writes all the buffers into a binary file that is decoded offline with the
+// smacc_trace_dump tool. Every process that traces dumps its buffers on exit into the file of its private
+// parameter ~smacc_trace_file (default /tmp/smacc_trace_<node name>.bin, empty to disable it). The size of the
+// buffers is the parameter ~smacc_trace_buffer_size (records per thread, default 16384).
+//
+// The tracer is the smacc_trace library, so that the nodes that only have trace points (like the local planners
+// inside move_base) can link it alone (${smacc_TRACE_LIBRARIES}) instead of the whole smacc library.
+//
+// The macros are only compiled if SMACC_TRACE_ENABLED is defined (cmake option SMACC_TRACING).
+// Otherwise they have no cost.
+#ifdef SMACC_TRACE_ENABLED
+#define SMACC_TRACE(name, ...)                                                                                          \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static ::smacc::trace::EventId smacc_trace_event_;                                                             \
+        ::smacc::trace::record(smacc_trace_event_, [&]() -> std::string { return name; }, ##__VA_ARGS__);              \
+    } while (0)
+#else
+#define SMACC_TRACE(name, ...)                                                                                         \
+    do                                                                                                                 \
+    {                                                                                                                  \
+    } while (0)
+#endif
+
+namespace smacc
+{
+namespace trace
+{
+const int MAX_ARGS = 6;
+
+struct Record
+{
+    // steady clock nanoseconds
+    uint64_t timestamp;
+    uint32_t thread;
+    uint32_t event;
+    uint64_t args[MAX_ARGS];
+};
+
+// file format: FileHeader, eventCount x (EventHeader, name, format), threadCount x (ThreadHeader, records)
+const char FILE_MAGIC[8] = { 'S', 'M', 'A', 'C', 'C', 'T', 'R', 'C' };
+const uint32_t FILE_VERSION = 1;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t eventCount;
+    uint32_t threadCount;
+    uint32_t reserved;
+
+    // clocks at dump time, to convert the steady timestamps into wall time
+    uint64_t steadyReference;
+    uint64_t systemReference;
+};
+
+struct EventHeader
+{
+    uint32_t id;
+    uint16_t nameLength;
+    uint16_t formatLength;
+};
+
+struct ThreadHeader
+{
+    uint32_t thread;
+    uint32_t osThreadId;
+    uint64_t recordCount;
+
+    // records overwritten before the dump
+    uint64_t lostCount;
+};
+
+// the id of each trace point is assigned the first time it is executed
+struct EventId
+{
+    std::atomic<uint32_t> id;
+};
+
+// argument format codes: 'i' signed integer, 'u' unsigned integer, 'd' floating point, 'p' pointer
+template <typename T>
+constexpr char argCode()
+{
+    return std::is_floating_point<T>::value ? 'd'
+         : std::is_pointer<T>::value ? 'p'
+         : std::is_signed<T>::value ? 'i' : 'u';
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint64_t>::type encodeArg(T value)
+{
+    double d = value;
+    uint64_t ret;
+    std::memcpy(&ret, &d, sizeof(ret));
+    return ret;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint64_t>::type encodeArg(T value)
+{
+    return (uint64_t)(int64_t)value;
+}
+
+template <typename T>
+inline uint64_t encodeArg(T* value)
+{
+    return (uint64_t)(uintptr_t)value;
+}
+
+uint32_t registerEvent(EventId& event, const std::string& name, const std::string& format);
+
+void write(uint32_t event, const uint64_t* args, int argCount);
+
+template <typename NameFunction, typename... Args>
+inline void record(EventId& event, NameFunction name, Args... args)
+{
+    static_assert(sizeof...(Args) <= MAX_ARGS, "too many trace arguments");
+
+    uint32_t id = event.id.load(std::memory_order_acquire);
+    if (id == 0)
+    {
+        const char format[] = { argCode<typename std::decay<Args>::type>()..., '\0' };
+        id = registerEvent(event, name(), format);
+    }
+
+    const uint64_t packed[] = { encodeArg(args)..., 0 };
+    write(id, packed, sizeof...(Args));
+}
+
+// number of records of the ring buffer of each thread (only for the threads that did not trace yet)
+void setBufferSize(std::size_t records);
+
+// writes all the ring buffers into a binary file. Returns false if it could not be written
+bool dump(const std::string& path);
+}
+}
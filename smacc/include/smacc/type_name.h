@@ -0,0 +1,68 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#pragma once
+
+#include <string>
+
+#ifndef __GNUC__
+#include <boost/core/demangle.hpp>
+#include <typeinfo>
+#endif
+
+namespace smacc
+{
+namespace detail
+{
+// the compiler writes the name of T into the signature of this function, ie (gcc):
+//   "const char* smacc::detail::typeSignature() [with T = ns::State]"
+#ifdef __GNUC__
+template <typename T>
+const char* typeSignature()
+{
+    return __PRETTY_FUNCTION__;
+}
+#endif
+
+// extracts the type name from the result of typeSignature()
+std::string typeNameFromSignature(const char* signature);
+
+// removes the namespaces and enclosing classes of a type name (not the ones of its template arguments)
+std::string shortTypeName(const std::string& typeName);
+
+// replaces the characters that are not valid in a ros name ('<', ',', ' ', ':'...) by '_'
+std::string rosName(const std::string& typeName);
+}
+
+// qualified name of the type (ie: "ns::State<ns::Arg>"). It is generated by the compiler, so it does not
+// need demangling. It is computed only once for each type
+template <typename T>
+const std::string& typeName()
+{
+#ifdef __GNUC__
+    static const std::string name = detail::typeNameFromSignature(detail::typeSignature<T>());
+#else
+    static const std::string name = boost::core::demangle(typeid(T).name());
+#endif
+    return name;
+}
+
+// name of the type without namespaces (ie: "State<ns::Arg>")
+template <typename T>
+const std::string& shortTypeName()
+{
+    static const std::string name = detail::shortTypeName(typeName<T>());
+    return name;
+}
+
+// name of the type without namespaces that can be used as a ros name, for the node handles of the
+// states (ie: "State_ns_Arg_3" for "State<ns::Arg, 3>"). It is the short name for non template types
+template <typename T>
+const std::string& rosTypeName()
+{
+    static const std::string name = detail::rosName(shortTypeName<T>());
+    return name;
+}
+}
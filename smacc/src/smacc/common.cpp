@@ -5,12 +5,18 @@
  ******************************************************************************************************************/
 #include "smacc/common.h"
 #include "smacc/smacc_action_client_base.h"
+#include <atomic>
 
 namespace smacc
 {
+namespace
+{
+std::atomic<bool> offlineMode(false);
+}
+
 actionlib::SimpleClientGoalState IActionResult::getResult() const
 {
-    return client->getState();
+    return resultState;
 }
 
 std::string cleanTypeName(const std::type_info& tinfo)
@@ -24,4 +30,14 @@ std::string cleanTypeName(const std::type_info& tinfo)
     //ROS_INFO("State classname: %s", classname.c_str());
     return classname;
 }
+
+void setOfflineMode(bool offline)
+{
+    offlineMode = offline;
+}
+
+bool isOfflineMode()
+{
+    return offlineMode;
+}
 }
\ No newline at end of file
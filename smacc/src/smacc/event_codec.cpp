@@ -0,0 +1,51 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/event_codec.h>
+
+namespace smacc
+{
+EventCodecRegistry& EventCodecRegistry::instance()
+{
+    static EventCodecRegistry registry;
+    return registry;
+}
+
+/**
+******************************************************************************************************************
+* add()
+******************************************************************************************************************
+*/
+void EventCodecRegistry::add(const std::type_info& type, const EventCodec& codec)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& entry = byType_[std::type_index(type)];
+    if (entry != nullptr)
+        return;
+
+    entry.reset(new EventCodec(codec));
+    byName_[codec.name] = entry.get();
+}
+
+/**
+******************************************************************************************************************
+* find()
+******************************************************************************************************************
+*/
+const EventCodec* EventCodecRegistry::find(const std::type_info& type) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byType_.find(std::type_index(type));
+    return it != byType_.end() ? it->second.get() : nullptr;
+}
+
+const EventCodec* EventCodecRegistry::find(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byName_.find(name);
+    return it != byName_.end() ? it->second : nullptr;
+}
+}
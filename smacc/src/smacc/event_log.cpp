@@ -0,0 +1,338 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/event_log.h>
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace smacc
+{
+namespace
+{
+// the file grows at least by this size, so that it is not remapped for each event
+const std::size_t MIN_GROWTH = 1 << 20;
+}
+
+EventLogWriter::EventLogWriter()
+    : fd_(-1), data_(nullptr), capacity_(0), size_(0), eventCount_(0)
+{
+}
+
+EventLogWriter::~EventLogWriter()
+{
+    close();
+}
+
+/**
+******************************************************************************************************************
+* open()
+******************************************************************************************************************
+*/
+bool EventLogWriter::open(const std::string& path)
+{
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        return false;
+
+    path_ = path;
+    size_ = 0;
+    eventCount_ = 0;
+    types_.clear();
+
+    if (!reserve(sizeof(event_log::FileHeader)))
+    {
+        close();
+        return false;
+    }
+
+    event_log::FileHeader header;
+    std::memcpy(header.magic, event_log::FILE_MAGIC, sizeof(header.magic));
+    header.version = event_log::FILE_VERSION;
+    header.reserved = 0;
+    header.startTime = ros::WallTime::now().toNSec();
+    std::memcpy(data_, &header, sizeof(header));
+    size_ = sizeof(header);
+    return true;
+}
+
+/**
+******************************************************************************************************************
+* close()
+******************************************************************************************************************
+*/
+void EventLogWriter::close()
+{
+    if (fd_ < 0)
+        return;
+
+    if (data_ != nullptr)
+    {
+        munmap(data_, capacity_);
+        data_ = nullptr;
+    }
+
+    // removes the unused tail of the last chunk
+    if (ftruncate(fd_, size_) != 0)
+    {
+        ROS_WARN_STREAM("the event log " << path_ << " could not be truncated");
+    }
+
+    ::close(fd_);
+    fd_ = -1;
+    capacity_ = 0;
+}
+
+bool EventLogWriter::isOpen() const
+{
+    return fd_ >= 0;
+}
+
+uint64_t EventLogWriter::getEventCount() const
+{
+    return eventCount_;
+}
+
+const std::string& EventLogWriter::getPath() const
+{
+    return path_;
+}
+
+/**
+******************************************************************************************************************
+* reserve()
+******************************************************************************************************************
+*/
+bool EventLogWriter::reserve(std::size_t bytes)
+{
+    if (size_ + bytes <= capacity_)
+        return true;
+
+    std::size_t capacity = std::max(capacity_ * 2, MIN_GROWTH);
+    while (capacity < size_ + bytes)
+        capacity *= 2;
+
+    // the new bytes of the file are zeros, that is, END records
+    if (ftruncate(fd_, capacity) != 0)
+        return false;
+
+    void* data = data_ == nullptr ? mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)
+                                  : mremap(data_, capacity_, capacity, MREMAP_MAYMOVE);
+    if (data == MAP_FAILED)
+        return false;
+
+    data_ = (uint8_t*)data;
+    capacity_ = capacity;
+    return true;
+}
+
+/**
+******************************************************************************************************************
+* write()
+******************************************************************************************************************
+*/
+void EventLogWriter::write(uint32_t kind, const void* payload1, uint32_t size1, const void* payload2, uint32_t size2)
+{
+    if (!reserve(sizeof(event_log::RecordHeader) + size1 + size2))
+    {
+        ROS_ERROR_STREAM_THROTTLE(1, "the event log " << path_ << " could not grow");
+        return;
+    }
+
+    event_log::RecordHeader header;
+    header.kind = kind;
+    header.size = size1 + size2;
+
+    // the header is written last, so that a crash never leaves a record with an incomplete payload
+    uint8_t* record = data_ + size_;
+    std::memcpy(record + sizeof(header), payload1, size1);
+    if (size2 > 0)
+        std::memcpy(record + sizeof(header) + size1, payload2, size2);
+    std::memcpy(record, &header, sizeof(header));
+
+    size_ += sizeof(header) + header.size;
+}
+
+/**
+******************************************************************************************************************
+* typeId()
+******************************************************************************************************************
+*/
+uint32_t EventLogWriter::typeId(const sc::event_base& evt, const EventCodec*& codec)
+{
+    std::type_index type(typeid(evt));
+    auto it = types_.find(type);
+    if (it != types_.end())
+    {
+        codec = it->second.codec;
+        return it->second.id;
+    }
+
+    LoggedType logged;
+    logged.id = types_.size();
+    logged.codec = EventCodecRegistry::instance().find(typeid(evt));
+
+    std::string name = logged.codec != nullptr ? logged.codec->name : boost::core::demangle(typeid(evt).name());
+    if (logged.codec == nullptr)
+    {
+        ROS_WARN_STREAM("the event " << name << " has no codec, it will not be replayed (see smacc::registerEventCodec)");
+    }
+
+    write(event_log::TYPE, &logged.id, sizeof(logged.id), name.data(), name.size());
+    types_[type] = logged;
+
+    codec = logged.codec;
+    return logged.id;
+}
+
+/**
+******************************************************************************************************************
+* append()
+******************************************************************************************************************
+*/
+void EventLogWriter::append(const sc::event_base& evt, uint64_t postTime, uint64_t dispatchTime)
+{
+    if (fd_ < 0)
+        return;
+
+    const EventCodec* codec;
+
+    event_log::EventHeader header;
+    header.postTime = postTime;
+    header.dispatchTime = dispatchTime;
+    header.type = typeId(evt, codec);
+    header.noCodec = codec == nullptr;
+
+    buffer_.clear();
+    if (codec != nullptr)
+        codec->encode(evt, buffer_);
+
+    write(event_log::EVENT, &header, sizeof(header), buffer_.data(), buffer_.size());
+    eventCount_++;
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+EventLogReader::EventLogReader()
+    : fd_(-1), data_(nullptr), size_(0), offset_(0)
+{
+}
+
+EventLogReader::~EventLogReader()
+{
+    close();
+}
+
+/**
+******************************************************************************************************************
+* open()
+******************************************************************************************************************
+*/
+bool EventLogReader::open(const std::string& path)
+{
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0 || (std::size_t)info.st_size < sizeof(event_log::FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    size_ = info.st_size;
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+
+    data_ = (const uint8_t*)data;
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, event_log::FILE_MAGIC, sizeof(header_.magic)) != 0 ||
+        header_.version != event_log::FILE_VERSION)
+    {
+        close();
+        return false;
+    }
+
+    offset_ = sizeof(header_);
+    return true;
+}
+
+void EventLogReader::close()
+{
+    if (data_ != nullptr)
+    {
+        munmap((void*)data_, size_);
+        data_ = nullptr;
+    }
+
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    size_ = 0;
+    offset_ = 0;
+    types_.clear();
+}
+
+const event_log::FileHeader& EventLogReader::getHeader() const
+{
+    return header_;
+}
+
+/**
+******************************************************************************************************************
+* next()
+******************************************************************************************************************
+*/
+bool EventLogReader::next(Event& event)
+{
+    while (data_ != nullptr && offset_ + sizeof(event_log::RecordHeader) <= size_)
+    {
+        event_log::RecordHeader header;
+        std::memcpy(&header, data_ + offset_, sizeof(header));
+
+        const uint8_t* payload = data_ + offset_ + sizeof(header);
+        if (header.kind == event_log::END || offset_ + sizeof(header) + header.size > size_)
+            return false;
+
+        offset_ += sizeof(header) + header.size;
+
+        if (header.kind == event_log::TYPE && header.size >= sizeof(uint32_t))
+        {
+            uint32_t id;
+            std::memcpy(&id, payload, sizeof(id));
+            if (id >= types_.size())
+                types_.resize(id + 1);
+
+            types_[id].assign((const char*)payload + sizeof(id), header.size - sizeof(id));
+        }
+        else if (header.kind == event_log::EVENT && header.size >= sizeof(event_log::EventHeader))
+        {
+            std::memcpy(&event.header, payload, sizeof(event.header));
+            event.type = event.header.type < types_.size() ? &types_[event.header.type] : nullptr;
+            event.payload = payload + sizeof(event.header);
+            event.size = header.size - sizeof(event.header);
+            return true;
+        }
+    }
+
+    return false;
+}
+}
@@ -0,0 +1,110 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/event_replay.h>
+
+namespace smacc
+{
+ReplayStats::ReplayStats()
+    : events(0), replayed(0), skipped(0), recordedSeconds(0), replaySeconds(0)
+{
+}
+
+void ReplayStats::toString(std::stringstream& ss) const
+{
+    ss << "events: " << events << ", replayed: " << replayed << ", skipped: " << skipped << std::endl;
+    ss << "recorded time: " << recordedSeconds << " s, replay time: " << replaySeconds << " s";
+    if (replaySeconds > 0)
+    {
+        ss << " (" << replayed / replaySeconds << " events/s, x" << recordedSeconds / replaySeconds << ")";
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+EventReplayer::EventReplayer()
+    : firstDispatchTime_(0), lastDispatchTime_(0)
+{
+}
+
+/**
+******************************************************************************************************************
+* open()
+******************************************************************************************************************
+*/
+bool EventReplayer::open(const std::string& path, const ReplayOptions& options)
+{
+    options_ = options;
+    stats_ = ReplayStats();
+    firstDispatchTime_ = 0;
+    lastDispatchTime_ = 0;
+    start_ = ros::WallTime::now();
+
+    return reader_.open(path);
+}
+
+/**
+******************************************************************************************************************
+* next()
+******************************************************************************************************************
+*/
+bool EventReplayer::next(EventPtr& event)
+{
+    EventLogReader::Event logged;
+    while (reader_.next(logged))
+    {
+        stats_.events++;
+
+        // the dispatch times are monotonic (the creation time of the custom events is unknown)
+        if (firstDispatchTime_ == 0)
+            firstDispatchTime_ = logged.header.dispatchTime;
+        lastDispatchTime_ = logged.header.dispatchTime;
+
+        // the codecs of the action events are registered when the states create their clients,
+        // so they are looked up just before the event is needed
+        const EventCodec* codec = nullptr;
+        if (!logged.header.noCodec && logged.type != nullptr)
+            codec = EventCodecRegistry::instance().find(*logged.type);
+
+        event = codec != nullptr ? codec->decode(logged.payload, logged.size) : EventPtr();
+        if (event == nullptr)
+        {
+            ROS_WARN_STREAM("[replay] skipping event " << (logged.type != nullptr ? *logged.type : "(unknown type)")
+                                                       << (codec == nullptr ? ": no codec" : ": invalid payload"));
+            stats_.skipped++;
+            continue;
+        }
+
+        wait(logged.header.dispatchTime);
+        stats_.replayed++;
+        return true;
+    }
+
+    return false;
+}
+
+void EventReplayer::wait(uint64_t dispatchTime)
+{
+    if (options_.speed <= 0)
+        return;
+
+    ros::WallTime due = start_ + ros::WallDuration().fromNSec((int64_t)((dispatchTime - firstDispatchTime_) / options_.speed));
+    ros::WallTime now = ros::WallTime::now();
+    if (due > now)
+        (due - now).sleep();
+}
+
+void EventReplayer::finish()
+{
+    stats_.replaySeconds = (ros::WallTime::now() - start_).toSec();
+    stats_.recordedSeconds = (lastDispatchTime_ - firstDispatchTime_) / 1e9;
+    reader_.close();
+}
+
+const ReplayStats& EventReplayer::getStats() const
+{
+    return stats_;
+}
+}
@@ -0,0 +1,183 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/latency_histogram.h>
+#include <iomanip>
+
+namespace smacc
+{
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+/**
+******************************************************************************************************************
+* record()
+******************************************************************************************************************
+*/
+void LatencyHistogram::record(int64_t nanoseconds)
+{
+    uint64_t value = nanoseconds > 0 ? nanoseconds : 0;
+
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t currentMax = max_.load(std::memory_order_relaxed);
+    while (value > currentMax && !max_.compare_exchange_weak(currentMax, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+******************************************************************************************************************
+* reset()
+******************************************************************************************************************
+*/
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : buckets_)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+/**
+******************************************************************************************************************
+* add()
+******************************************************************************************************************
+*/
+void LatencyHistogram::add(const LatencyHistogram& other)
+{
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        buckets_[i].fetch_add(other.bucketCount(i), std::memory_order_relaxed);
+    }
+
+    count_.fetch_add(other.count(), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t otherMax = other.max();
+    uint64_t currentMax = max_.load(std::memory_order_relaxed);
+    while (otherMax > currentMax && !max_.compare_exchange_weak(currentMax, otherMax, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return count_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    if (n == 0)
+        return 0;
+
+    return (double)sum_.load(std::memory_order_relaxed) / n;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+    return max_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucketCount(int bucketIndex) const
+{
+    return buckets_[bucketIndex].load(std::memory_order_relaxed);
+}
+
+/**
+******************************************************************************************************************
+* bucketIndex()
+******************************************************************************************************************
+*/
+int LatencyHistogram::bucketIndex(uint64_t nanoseconds)
+{
+    // the first SUB_BUCKETS values have their own bucket
+    if (nanoseconds < (uint64_t)SUB_BUCKETS)
+        return nanoseconds;
+
+    int magnitude = 63 - __builtin_clzll(nanoseconds);
+    if (magnitude >= MAX_MAGNITUDE)
+        return BUCKET_COUNT - 1;
+
+    int subBucket = (nanoseconds >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int bucketIndex)
+{
+    if (bucketIndex < SUB_BUCKETS)
+        return bucketIndex;
+
+    int magnitude = bucketIndex / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = bucketIndex % SUB_BUCKETS;
+    return (SUB_BUCKETS + subBucket) << (magnitude - SUB_BUCKET_BITS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucketIndex)
+{
+    if (bucketIndex < SUB_BUCKETS)
+        return bucketIndex + 1;
+
+    int magnitude = bucketIndex / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    return bucketLowerBound(bucketIndex) + ((uint64_t)1 << (magnitude - SUB_BUCKET_BITS));
+}
+
+/**
+******************************************************************************************************************
+* percentile()
+******************************************************************************************************************
+*/
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    uint64_t n = count();
+    if (n == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)(p * n);
+    uint64_t accumulated = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        accumulated += bucketCount(i);
+        if (accumulated > target)
+        {
+            return bucketUpperBound(i);
+        }
+    }
+
+    return max();
+}
+
+/**
+******************************************************************************************************************
+* toString()
+******************************************************************************************************************
+*/
+void LatencyHistogram::toString(std::stringstream& ss) const
+{
+    ss << "samples: " << count() << ", mean: " << mean() / 1000.0 << " us"
+       << ", p50: < " << percentile(0.5) / 1000.0 << " us"
+       << ", p99: < " << percentile(0.99) / 1000.0 << " us"
+       << ", max: " << max() / 1000.0 << " us" << std::endl;
+
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        uint64_t bucket = bucketCount(i);
+        if (bucket == 0)
+            continue;
+
+        ss << " [" << std::setw(12) << bucketLowerBound(i) / 1000.0 << " us, "
+           << std::setw(12) << bucketUpperBound(i) / 1000.0 << " us): " << bucket << std::endl;
+    }
+}
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/pool_allocator.h>
+
+namespace smacc
+{
+SmaccAllocationStats::SmaccAllocationStats()
+    : poolAllocations(0), poolDeallocations(0), systemAllocations(0), systemBytes(0), heapAllocationCounter_(nullptr)
+{
+}
+
+SmaccAllocationStats& SmaccAllocationStats::instance()
+{
+    static SmaccAllocationStats stats;
+    return stats;
+}
+
+void SmaccAllocationStats::setHeapAllocationCounter(uint64_t (*counter)())
+{
+    instance().heapAllocationCounter_.store(counter, std::memory_order_release);
+}
+
+bool SmaccAllocationStats::countsHeapAllocations() const
+{
+    return heapAllocationCounter_.load(std::memory_order_acquire) != nullptr;
+}
+
+uint64_t SmaccAllocationStats::heapAllocations() const
+{
+    auto counter = heapAllocationCounter_.load(std::memory_order_acquire);
+    return counter != nullptr ? counter() : 0;
+}
+
+void SmaccAllocationStats::toString(std::stringstream& ss) const
+{
+    ss << "pool allocations: " << poolAllocations.load() << ", pool deallocations: " << poolDeallocations.load()
+       << ", system allocations: " << systemAllocations.load() << " (" << systemBytes.load() << " bytes)";
+
+    if(countsHeapAllocations())
+        ss << ", heap allocations (whole process): " << heapAllocations();
+    else
+        ss << ", heap allocations: not counted";
+}
+
+char* SmaccPoolUserAllocator::malloc BOOST_PREVENT_MACRO_SUBSTITUTION(const size_type bytes)
+{
+    auto& stats = SmaccAllocationStats::instance();
+    stats.systemAllocations.fetch_add(1, std::memory_order_relaxed);
+    stats.systemBytes.fetch_add(bytes, std::memory_order_relaxed);
+    return new (std::nothrow) char[bytes];
+}
+
+void SmaccPoolUserAllocator::free BOOST_PREVENT_MACRO_SUBSTITUTION(char* const block)
+{
+    delete[] block;
+}
+}
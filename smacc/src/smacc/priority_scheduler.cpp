@@ -0,0 +1,31 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/priority_scheduler.h>
+
+namespace smacc
+{
+/**
+******************************************************************************************************************
+* eventLaneName()
+******************************************************************************************************************
+*/
+const char* eventLaneName(EventLane lane)
+{
+    switch (lane)
+    {
+    case EventLane::CRITICAL:
+        return "critical";
+    case EventLane::RESULT:
+        return "result";
+    case EventLane::FEEDBACK:
+        return "feedback";
+    case EventLane::TELEMETRY:
+        return "telemetry";
+    }
+
+    return "unknown";
+}
+}
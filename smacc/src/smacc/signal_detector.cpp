@@ -5,6 +5,9 @@
  ******************************************************************************************************************/
 #include <smacc/signal_detector.h>
 #include <smacc/smacc_action_client_base.h>
+#include <ros/callback_queue.h>
+#include <fstream>
+#include <set>
 
 namespace smacc
 {
@@ -13,10 +16,19 @@ namespace smacc
 * SignalDetector()
 ******************************************************************************************************************
 */
-SignalDetector::SignalDetector(SmaccScheduler* scheduler)
+SignalDetector::SignalDetector()
 {
-    scheduler_ = scheduler;
     loop_rate_hz = 10.0;
+    eventDriven_ = false;
+
+    // it has to be known before the state machine sends its first goal
+    ros::NodeHandle nh("~");
+    nh.param("signal_detector_event_driven", eventDriven_, eventDriven_);
+    // offline mode: there is no polling loop, the fake action servers call the client callbacks
+    if(isOfflineMode())
+        eventDriven_ = true;
+    else
+        nh.setParam("signal_detector_event_driven", eventDriven_);
 }
 
 /**
@@ -27,8 +39,70 @@ SignalDetector::SignalDetector(SmaccScheduler* scheduler)
 void SignalDetector::registerActionClientRequest(ISmaccActionClient* actionClientRequestInfo)
 {
     ROS_INFO("Signal detector is aware of the '-- %s -- action client request'", actionClientRequestInfo->getName().c_str());
-    openRequests_.push_back(actionClientRequestInfo);
-    ROS_INFO("Added to the opened requests list");
+
+    // in event-driven mode the action client notifies its own results and feedback
+    if(eventDriven_)
+        return;
+
+    // a new goal of a client that already has an open request does not add a new entry, it only makes
+    // the registry keep the client when the previous goal is finalized
+    if(openRequests_.add(actionClientRequestInfo))
+    {
+        ROS_INFO("Added to the opened requests list (%ld open requests)", openRequests_.size());
+    }
+}
+
+/**
+******************************************************************************************************************
+* isEventDriven()
+******************************************************************************************************************
+*/
+bool SignalDetector::isEventDriven() const
+{
+    return eventDriven_;
+}
+
+/**
+******************************************************************************************************************
+* onActionResult()
+******************************************************************************************************************
+*/
+void SignalDetector::onActionResult(ISmaccActionClient* client)
+{
+    finalizeRequest(client);
+}
+
+/**
+******************************************************************************************************************
+* onActionFeedback()
+******************************************************************************************************************
+*/
+void SignalDetector::onActionFeedback(ISmaccActionClient* client)
+{
+    notifyFeedback(client);
+}
+
+/**
+******************************************************************************************************************
+* postEvent()
+******************************************************************************************************************
+*/
+void SignalDetector::postEvent(ISmaccActionClient* client, const boost::intrusive_ptr<const sc::event_base>& event, EventLane lane)
+{
+    postEvent(client->getStateMachine(), event, lane);
+}
+
+void SignalDetector::postEvent(ISmaccStateMachine* stateMachine, const boost::intrusive_ptr<const sc::event_base>& event, EventLane lane)
+{
+    auto smaccEvent = dynamic_cast<const ISmaccEvent*>(event.get());
+    if(smaccEvent != nullptr)
+        smaccEvent->markQueued();
+
+    queueEvent(stateMachine->getScheduler(), stateMachine->getProcessorHandle(), event, lane);
+    if(eventQueuedCallback_)
+    {
+        eventQueuedCallback_(stateMachine);
+    }
 }
 
 /**
@@ -38,17 +112,49 @@ void SignalDetector::registerActionClientRequest(ISmaccActionClient* actionClien
 */
 void SignalDetector::initialize(ISmaccStateMachine* stateMachine)
 {
-    smaccStateMachine_ = stateMachine;
+    std::lock_guard<std::mutex> lock(stateMachinesMutex_);
+    stateMachines_.push_back(stateMachine);
+}
+
+/**
+******************************************************************************************************************
+* setInstanceNamespace()
+******************************************************************************************************************
+*/
+void SignalDetector::setInstanceNamespace(const SmaccScheduler* scheduler, const std::string& ns)
+{
+    std::lock_guard<std::mutex> lock(stateMachinesMutex_);
+    instanceNamespaces_[scheduler] = ns;
+}
+
+std::string SignalDetector::getInstanceNamespace(const SmaccScheduler* scheduler)
+{
+    std::lock_guard<std::mutex> lock(stateMachinesMutex_);
+    auto it = instanceNamespaces_.find(scheduler);
+    return it != instanceNamespaces_.end() ? it->second : std::string();
 }
 
 /**
 ******************************************************************************************************************
-* setProcessorHandle()
+* setEventQueuedCallback()
 ******************************************************************************************************************
 */
-void SignalDetector::setProcessorHandle(SmaccScheduler::processor_handle processorHandle)
+void SignalDetector::setEventQueuedCallback(boost::function<void(ISmaccStateMachine*)> callback)
 {
-    processorHandle_ = processorHandle;
+    eventQueuedCallback_ = callback;
+}
+
+/**
+******************************************************************************************************************
+* onEventQueued()
+******************************************************************************************************************
+*/
+void SignalDetector::onEventQueued(ISmaccActionClient* client)
+{
+    if(eventQueuedCallback_)
+    {
+        eventQueuedCallback_(client->getStateMachine());
+    }
 }
 
 /**
@@ -82,7 +188,12 @@ void SignalDetector::notifyFeedback(ISmaccActionClient* client)
     //boost::intrusive_ptr< EvActionFeedback > actionFeedbackEvent = new EvActionFeedback();
     //actionFeedbackEvent->client = client;
 
-    client->postFeedbackEvent(scheduler_, processorHandle_);
+    SMACC_TRACE("signal_detector/feedback", client);
+    ISmaccStateMachine* stateMachine = client->getStateMachine();
+    if(client->postFeedbackEvent(&stateMachine->getScheduler(), stateMachine->getProcessorHandle()))
+    {
+        onEventQueued(client);
+    }
     
     //ROS_INFO("Sending feedback event");
     //scheduler_->queue_event(processorHandle_, actionFeedbackEvent);
@@ -95,22 +206,16 @@ void SignalDetector::notifyFeedback(ISmaccActionClient* client)
 */
 void SignalDetector::finalizeRequest(ISmaccActionClient* client)
 {
-    ROS_INFO("SignalDetector: Finalizing actionlib request: %s. RESULT: %s", client->getName().c_str(), client->getState().toString().c_str());
-    auto it = find(openRequests_.begin(),openRequests_.end(),client);
-
-    if (it != openRequests_.end())
-    {
-        openRequests_.erase(it);
-    }
+    ROS_DEBUG("SignalDetector: Finalizing actionlib request: %s. RESULT: %s", client->getName().c_str(), client->getState().toString().c_str());
+    SMACC_TRACE("signal_detector/result", client, (int)client->getState().state_);
 
     //boost::intrusive_ptr< IActionResult> actionClientResultEvent = client->createActionResultEvent();
     //actionClientResultEvent->client = client;
 
-    ROS_INFO("SignalDetector: Sending successEvent");
-    client->postEvent(scheduler_, processorHandle_);
-    // SmaccScheduler
-    //SmaccScheduler::processor_handle
-    //scheduler_->queue_event(processorHandle_, actionClientResultEvent);
+    ROS_DEBUG("SignalDetector: Sending successEvent");
+    ISmaccStateMachine* stateMachine = client->getStateMachine();
+    client->postEvent(&stateMachine->getScheduler(), stateMachine->getProcessorHandle());
+    onEventQueued(client);
 }
 
 /**
@@ -122,11 +227,11 @@ void SignalDetector::toString(std::stringstream& ss)
 {
     ss << "--------" << std::endl;
     ss << "Open requests" << std::endl;
-    for(ISmaccActionClient* smaccActionClient: this->openRequests_)
+    openRequests_.forEach([&](ISmaccActionClient* smaccActionClient)
     {
         auto state = smaccActionClient->getState().toString();
         ss << smaccActionClient->getName() << ": " << state << std::endl;
-    }
+    });
     ss << "--------";
 }
 
@@ -137,8 +242,13 @@ void SignalDetector::toString(std::stringstream& ss)
 */
 void SignalDetector::pollOnce()
 {
-    for(ISmaccActionClient* smaccActionClient: openRequests_)
+    // removing the client from the registry is safe while iterating it
+    openRequests_.forEach([this](ISmaccActionClient* smaccActionClient)
     {
+        // read before the state: if the state machine sends a new goal meanwhile, the client is kept
+        // registered for it and the result of the finished goal (already replaced) is not posted
+        unsigned long generation = smaccActionClient->getRegistryGeneration();
+
         // check feedback messages
         if (smaccActionClient->hasFeedback())
         {
@@ -147,11 +257,11 @@ void SignalDetector::pollOnce()
 
         // check result
         auto state = smaccActionClient->getState();
-        if(state.isDone())
+        if(state.isDone() && openRequests_.remove(smaccActionClient, generation))
         {
             finalizeRequest(smaccActionClient);
         }
-    }            
+    });
 }
 
 /**
@@ -169,14 +279,136 @@ void SignalDetector::pollingLoop()
 
     nh.setParam("signal_detector_loop_freq",this->loop_rate_hz);
 
-    ros::Rate r(loop_rate_hz);
-
     ROS_INFO_STREAM("[SignalDetector] loop rate hz:" << loop_rate_hz);
-    while (ros::ok())
+    ROS_INFO_STREAM("[SignalDetector] event driven:" << eventDriven_);
+
+    // the timers are dispatched by this loop
+    double stateTimingPeriod;
+    nh.param("smacc_state_timing_period", stateTimingPeriod, 5.0);
+    if(stateTimingPeriod > 0)
+    {
+        stateTimingsPub_ = nh.advertise<smacc::StateTimings>("state_timings", 1);
+        stateTimingsTimer_ = nh.createWallTimer(ros::WallDuration(stateTimingPeriod), &SignalDetector::publishStateTimings, this);
+    }
+
+    if(eventDriven_)
+    {
+        // the actionlib callbacks post the events, so that we only have to wake up when
+        // there is some callback to dispatch (instead of waiting the next polling cycle)
+        ros::WallDuration timeout(1.0 / loop_rate_hz);
+        while (ros::ok())
+        {
+            ros::getGlobalCallbackQueue()->callAvailable(timeout);
+        }
+    }
+    else
     {
-        pollOnce();
-        ros::spinOnce();
-        r.sleep();
+        ros::Rate r(loop_rate_hz);
+        while (ros::ok())
+        {
+            pollOnce();
+            ros::spinOnce();
+            r.sleep();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMachinesMutex_);
+        LatencyHistogram eventLatency;
+        for(auto* stateMachine: stateMachines_)
+        {
+            eventLatency.add(stateMachine->getEventLatencyHistogram());
+        }
+
+        std::stringstream ss;
+        eventLatency.toString(ss);
+        ROS_INFO_STREAM("[SignalDetector] event to reaction latency (" << stateMachines_.size() << " state machines): " << std::endl << ss.str());
     }
-}   
-}
\ No newline at end of file
+
+    std::stringstream ss;
+    SmaccAllocationStats::instance().toString(ss);
+    ROS_INFO_STREAM("[SignalDetector] smacc allocator: " << ss.str());
+
+    stateTimingsTimer_.stop();
+    std::string stateTimingFile;
+    nh.param<std::string>("smacc_state_timing_file", stateTimingFile, "");
+    if(!stateTimingFile.empty())
+    {
+        dumpStateTimings(stateTimingFile);
+    }
+}
+
+/**
+******************************************************************************************************************
+* getStateMachines()
+******************************************************************************************************************
+*/
+std::vector<ISmaccStateMachine*> SignalDetector::getStateMachines()
+{
+    std::lock_guard<std::mutex> lock(stateMachinesMutex_);
+    return stateMachines_;
+}
+
+/**
+******************************************************************************************************************
+* getStateTimingTables()
+******************************************************************************************************************
+*/
+std::vector<StateTimingTable*> SignalDetector::getStateTimingTables()
+{
+    std::lock_guard<std::mutex> lock(stateMachinesMutex_);
+
+    // the instances of the same state machine type share their table
+    std::vector<StateTimingTable*> tables;
+    std::set<StateTimingTable*> added;
+    for(auto* stateMachine: stateMachines_)
+    {
+        auto* table = &stateMachine->getStateTimings();
+        if(added.insert(table).second)
+        {
+            tables.push_back(table);
+        }
+    }
+
+    return tables;
+}
+
+/**
+******************************************************************************************************************
+* publishStateTimings()
+******************************************************************************************************************
+*/
+void SignalDetector::publishStateTimings(const ros::WallTimerEvent&)
+{
+    for(auto* table: getStateTimingTables())
+    {
+        smacc::StateTimings msg;
+        msg.header.stamp = ros::Time::now();
+        table->toMsg(msg);
+        stateTimingsPub_.publish(msg);
+    }
+}
+
+/**
+******************************************************************************************************************
+* dumpStateTimings()
+******************************************************************************************************************
+*/
+void SignalDetector::dumpStateTimings(const std::string& path)
+{
+    std::ofstream file(path);
+    if(!file)
+    {
+        ROS_ERROR_STREAM("[SignalDetector] the state timing could not be written to " << path);
+        return;
+    }
+
+    StateTimingTable::csvHeader(file);
+    for(auto* table: getStateTimingTables())
+    {
+        table->toCsv(file);
+    }
+
+    ROS_INFO_STREAM("[SignalDetector] state timing written to " << path);
+}
+}
@@ -25,10 +25,17 @@ void ISmaccActionClient::init(ros::NodeHandle& nh)
     ROS_DEBUG("Creating Action Client %s", name_.c_str());
 }
 
+void ISmaccActionClient::initOffline(ros::NodeHandle& nh)
+{
+    name_ = nh.getNamespace();
+    ROS_DEBUG("Creating offline Action Client %s", name_.c_str());
+}
+
 //-----------------------------------------------------------------------
 
 ISmaccComponent::~ISmaccComponent()
 {
+    ISmaccComponent::shutdown();
 }
 
 
@@ -41,11 +48,55 @@ void ISmaccComponent::init(ros::NodeHandle& nh)
 
 }
 
+void ISmaccComponent::initOffline(ros::NodeHandle& nh)
+{
+
+}
+
+bool ISmaccComponent::waitUntilReady(ros::WallDuration timeout)
+{
+    return true;
+}
+
 void ISmaccComponent::setStateMachine(ISmaccStateMachine* stateMachine)
 {
     stateMachine_ = stateMachine;
 }
 
+ISmaccStateMachine* ISmaccComponent::getStateMachine() const
+{
+    return stateMachine_;
+}
+
+void ISmaccComponent::setDedicatedCallbackQueue(ros::NodeHandle& nh, int threads)
+{
+    callbackQueue_.reset(new ros::CallbackQueue());
+    callbackSpinner_.reset(new ros::AsyncSpinner(threads, callbackQueue_.get()));
+    nh.setCallbackQueue(callbackQueue_.get());
+}
+
+void ISmaccComponent::startCallbackSpinner()
+{
+    if(callbackSpinner_)
+    {
+        callbackSpinner_->start();
+    }
+}
+
+ros::CallbackQueue* ISmaccComponent::getCallbackQueue() const
+{
+    return callbackQueue_.get();
+}
+
+void ISmaccComponent::shutdown()
+{
+    // it waits for the callbacks that are running
+    if(callbackSpinner_)
+    {
+        callbackSpinner_->stop();
+    }
+}
+
 std::string ISmaccComponent::getName() const
 {
     std::string keyname = boost::core::demangle(typeid(this).name());
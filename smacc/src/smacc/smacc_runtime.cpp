@@ -0,0 +1,303 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/smacc_runtime.h>
+
+#include <cstdio>
+
+namespace smacc
+{
+namespace
+{
+// the runtime and worker index of the current thread (if it is a worker thread)
+thread_local SmaccRuntime* currentRuntime = nullptr;
+thread_local int currentWorkerIndex = -1;
+}
+
+SmaccRuntime::HostedStateMachine::HostedStateMachine()
+    : status((int)HostedStatus::IDLE)
+{
+}
+
+/**
+******************************************************************************************************************
+* SmaccRuntime()
+******************************************************************************************************************
+*/
+SmaccRuntime::SmaccRuntime(int threadCount)
+    : stopping_(false), pendingCount_(0), idleWorkers_(0), nextQueue_(0), stealCount_(0)
+{
+    threadCount_ = threadCount;
+    if (threadCount_ <= 0)
+    {
+        ros::NodeHandle nh("~");
+        nh.param("smacc_runtime_threads", threadCount_, (int)boost::thread::hardware_concurrency());
+        if (threadCount_ <= 0)
+            threadCount_ = 1;
+    }
+
+    int batchSize;
+    ros::NodeHandle nh("~");
+    nh.param("smacc_runtime_batch_size", batchSize, 32);
+    batchSize_ = batchSize > 0 ? batchSize : 1;
+
+    for (int i = 0; i < threadCount_; i++)
+    {
+        queues_.emplace_back(new WorkerQueue());
+    }
+
+    signalDetector_.setEventQueuedCallback(boost::bind(&SmaccRuntime::onEventQueued, this, _1));
+
+    ROS_INFO("SmaccRuntime created with %d worker threads", threadCount_);
+}
+
+SmaccRuntime::~SmaccRuntime()
+{
+    stop();
+
+    // the state machines are destroyed by their schedulers
+    stateMachines_.clear();
+}
+
+/**
+******************************************************************************************************************
+* run()
+******************************************************************************************************************
+*/
+void SmaccRuntime::run()
+{
+    ROS_INFO("SmaccRuntime: running %ld state machines on %d threads", stateMachines_.size(), threadCount_);
+
+    for (int i = 0; i < threadCount_; i++)
+    {
+        workers_.emplace_back(boost::bind(&SmaccRuntime::workerLoop, this, i));
+    }
+
+    // use the current thread for the shared signal detector
+    signalDetector_.pollingLoop();
+
+    stop();
+}
+
+/**
+******************************************************************************************************************
+* stop()
+******************************************************************************************************************
+*/
+void SmaccRuntime::stop()
+{
+    stopping_ = true;
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idleCondition_.notify_all();
+    }
+
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+
+    workers_.clear();
+}
+
+SignalDetector& SmaccRuntime::getSignalDetector()
+{
+    return signalDetector_;
+}
+
+int SmaccRuntime::getThreadCount() const
+{
+    return threadCount_;
+}
+
+int SmaccRuntime::getStateMachineCount() const
+{
+    return stateMachines_.size();
+}
+
+unsigned long SmaccRuntime::getStealCount() const
+{
+    return stealCount_.load(std::memory_order_relaxed);
+}
+
+std::string SmaccRuntime::formatNamespace(const std::string& format, int index)
+{
+    char ns[256];
+    snprintf(ns, sizeof(ns), format.c_str(), index);
+    return ns;
+}
+
+/**
+******************************************************************************************************************
+* onEventQueued()
+******************************************************************************************************************
+*/
+void SmaccRuntime::onEventQueued(ISmaccStateMachine* stateMachine)
+{
+    auto it = schedulerIndex_.find(&stateMachine->getScheduler());
+    if (it != schedulerIndex_.end())
+    {
+        schedule(it->second);
+    }
+}
+
+/**
+******************************************************************************************************************
+* schedule()
+******************************************************************************************************************
+*/
+void SmaccRuntime::schedule(HostedStateMachine* hosted)
+{
+    for (;;)
+    {
+        int status = hosted->status.load();
+        if (status == (int)HostedStatus::IDLE)
+        {
+            if (hosted->status.compare_exchange_weak(status, (int)HostedStatus::SCHEDULED))
+            {
+                push(hosted);
+                return;
+            }
+        }
+        else if (status == (int)HostedStatus::RUNNING)
+        {
+            // the worker that is running it will reschedule it when it finishes
+            if (hosted->status.compare_exchange_weak(status, (int)HostedStatus::RUNNING_RESCHEDULE))
+                return;
+        }
+        else
+        {
+            // already scheduled
+            return;
+        }
+    }
+}
+
+/**
+******************************************************************************************************************
+* push()
+******************************************************************************************************************
+*/
+void SmaccRuntime::push(HostedStateMachine* hosted)
+{
+    // worker threads keep their own work locally, other threads distribute it round robin
+    int queueIndex;
+    if (currentRuntime == this)
+        queueIndex = currentWorkerIndex;
+    else
+        queueIndex = nextQueue_.fetch_add(1, std::memory_order_relaxed) % threadCount_;
+
+    {
+        std::lock_guard<std::mutex> lock(queues_[queueIndex]->mutex);
+        queues_[queueIndex]->ready.push_back(hosted);
+    }
+
+    pendingCount_.fetch_add(1);
+
+    if (idleWorkers_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idleCondition_.notify_one();
+    }
+}
+
+/**
+******************************************************************************************************************
+* pop()
+******************************************************************************************************************
+*/
+SmaccRuntime::HostedStateMachine* SmaccRuntime::pop(int workerIndex)
+{
+    // own queue: oldest first
+    {
+        auto& queue = *queues_[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.ready.empty())
+        {
+            auto hosted = queue.ready.front();
+            queue.ready.pop_front();
+            return hosted;
+        }
+    }
+
+    // steal from the back of the other queues
+    for (int i = 1; i < threadCount_; i++)
+    {
+        auto& queue = *queues_[(workerIndex + i) % threadCount_];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.ready.empty())
+        {
+            auto hosted = queue.ready.back();
+            queue.ready.pop_back();
+            stealCount_.fetch_add(1, std::memory_order_relaxed);
+            return hosted;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+******************************************************************************************************************
+* execute()
+******************************************************************************************************************
+*/
+void SmaccRuntime::execute(HostedStateMachine* hosted)
+{
+    hosted->status.store((int)HostedStatus::RUNNING);
+
+    // the scheduler is in non-blocking mode: it returns when its queue is empty
+    unsigned long processed = (*hosted->scheduler)(batchSize_);
+    SMACC_TRACE("runtime/execute", hosted, processed);
+
+    if (processed >= batchSize_)
+    {
+        // it may have more events, let other state machines run before
+        hosted->status.store((int)HostedStatus::SCHEDULED);
+        push(hosted);
+        return;
+    }
+
+    int expected = (int)HostedStatus::RUNNING;
+    if (!hosted->status.compare_exchange_strong(expected, (int)HostedStatus::IDLE))
+    {
+        // some event was queued while it was running
+        hosted->status.store((int)HostedStatus::SCHEDULED);
+        push(hosted);
+    }
+}
+
+/**
+******************************************************************************************************************
+* workerLoop()
+******************************************************************************************************************
+*/
+void SmaccRuntime::workerLoop(int workerIndex)
+{
+    currentRuntime = this;
+    currentWorkerIndex = workerIndex;
+
+    while (!stopping_)
+    {
+        HostedStateMachine* hosted = pop(workerIndex);
+
+        if (hosted == nullptr)
+        {
+            std::unique_lock<std::mutex> lock(idleMutex_);
+            idleWorkers_.fetch_add(1);
+            idleCondition_.wait_for(lock, std::chrono::milliseconds(100),
+                                    [this]() { return stopping_ || pendingCount_.load() > 0; });
+            idleWorkers_.fetch_sub(1);
+            continue;
+        }
+
+        pendingCount_.fetch_sub(1);
+        execute(hosted);
+    }
+
+    currentRuntime = nullptr;
+    currentWorkerIndex = -1;
+}
+}
@@ -5,20 +5,59 @@
  ******************************************************************************************************************/
 #include <smacc/smacc_state_machine.h>
 #include <smacc/signal_detector.h>
+#include <smacc/component.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 
 namespace smacc
 {
 ISmaccStateMachine::ISmaccStateMachine( SignalDetector* signalDetector)
+    : transitionCount_(0), componentReadyTimeout_(0), componentsReadyCancelled_(false), componentStartupTime_(0),
+      componentsNotReady_(0)
 {
     ROS_INFO("Creating State Machine Base");
     signalDetector_ = signalDetector;
     signalDetector_->initialize(this);
+
+    if(!isOfflineMode())
+    {
+        ros::NodeHandle nh("~");
+        std::string eventLogFile;
+        nh.param<std::string>("smacc_event_log_file", eventLogFile, "");
+        if(!eventLogFile.empty())
+        {
+            // each instance of the state machine writes its own log (SmaccRuntime)
+            static std::atomic<int> instanceCount(0);
+            int instance = instanceCount++;
+            if(instance > 0)
+                eventLogFile += "." + std::to_string(instance);
+
+            eventLog_.reset(new EventLogWriter());
+            if(eventLog_->open(eventLogFile))
+            {
+                ROS_INFO_STREAM("Recording the state machine events into " << eventLogFile);
+            }
+            else
+            {
+                ROS_ERROR_STREAM("The event log " << eventLogFile << " could not be created");
+                eventLog_.reset();
+            }
+        }
+    }
 } 
 
 ISmaccStateMachine::~ISmaccStateMachine( )
 {
     ROS_INFO("Finishing State Machine");
+    stopComponentsReadyWait();
+
+    if(eventLog_)
+    {
+        ROS_INFO_STREAM(eventLog_->getEventCount() << " events recorded into " << eventLog_->getPath());
+    }
 }
 
 /// used by the actionclients when a new send goal is launched
@@ -29,4 +68,201 @@ void ISmaccStateMachine::registerActionClientRequest(ISmaccActionClient* client)
     ROS_INFO("Registering action client request: %s", client->getName().c_str());  
     signalDetector_->registerActionClientRequest(client); 
 }
+
+SignalDetector* ISmaccStateMachine::getSignalDetector() const
+{
+    return signalDetector_;
+}
+
+void ISmaccStateMachine::postEvent(const boost::intrusive_ptr<const sc::event_base>& event, EventLane lane)
+{
+    signalDetector_->postEvent(this, event, lane);
+}
+
+bool ISmaccStateMachine::markStateEntered(StateId state)
+{
+    if(state == NO_STATE || (std::size_t)state >= enteredStates_.size() || enteredStates_[state])
+        return false;
+
+    enteredStates_[state] = true;
+    return true;
+}
+
+const std::string& ISmaccStateMachine::getInstanceNamespace() const
+{
+    return instanceNamespace_;
+}
+
+ros::NodeHandle ISmaccStateMachine::getInstanceNodeHandle(const ros::NodeHandle& nh) const
+{
+    if(instanceNamespace_.empty())
+        return nh;
+
+    const std::string& ns = nh.getNamespace();
+    return ros::NodeHandle(ns == "/" ? instanceNamespace_ : instanceNamespace_ + ns);
+}
+
+Blackboard& ISmaccStateMachine::getBlackboard()
+{
+    return blackboard_;
+}
+
+const LatencyHistogram& ISmaccStateMachine::getEventLatencyHistogram() const
+{
+    return eventLatencyHistogram_;
+}
+
+const LatencyHistogram& ISmaccStateMachine::getReactionLatencyHistogram() const
+{
+    return reactionLatencyHistogram_;
+}
+
+uint64_t ISmaccStateMachine::getTransitionCount() const
+{
+    return transitionCount_.load(std::memory_order_relaxed);
+}
+
+ros::WallDuration ISmaccStateMachine::getComponentStartupTime() const
+{
+    return ros::WallDuration().fromNSec(componentStartupTime_.load(std::memory_order_acquire));
+}
+
+int ISmaccStateMachine::getComponentsNotReadyCount() const
+{
+    return componentsNotReady_.load(std::memory_order_acquire);
+}
+
+int ISmaccStateMachine::getComponentCallbackThreads(const std::string& componentName) const
+{
+    ros::NodeHandle nh("~");
+    int threads;
+    nh.param("smacc_component_callback_threads", threads, 0);
+    nh.param("smacc_components/" + componentName + "/callback_threads", threads, threads);
+    return threads;
+}
+
+void ISmaccStateMachine::prewarmComponents(const ComponentDeclarations& components)
+{
+    ros::NodeHandle nh("~");
+    bool prewarm;
+    nh.param("smacc_component_prewarm", prewarm, true);
+    nh.param("smacc_component_ready_timeout", componentReadyTimeout_, 5.0);
+
+    if(!prewarm || components.empty())
+        return;
+
+    // the connections are not waited here, the state machine is being created in the scheduler thread
+    for(const ComponentDeclaration& declaration: components.get())
+    {
+        prewarmedComponents_.push_back(declaration.factory(*this, declaration.ns));
+    }
+
+    ROS_INFO_STREAM(prewarmedComponents_.size() << " components created at startup");
+}
+
+void ISmaccStateMachine::startComponentsReadyWait()
+{
+    // offline mode: the components have no connections (initOffline)
+    if(prewarmedComponents_.empty() || isOfflineMode() || componentsReadyThread_.joinable())
+        return;
+
+    componentsReadyThread_ = std::thread([this]()
+    {
+        // the components are checked in turns (waitUntilReady with a zero timeout does not block), so the
+        // startup takes as long as the slowest component and the wait can be cancelled at any time
+        auto start = ros::WallTime::now();
+        auto deadline = start + ros::WallDuration(componentReadyTimeout_);
+        std::vector<ISmaccComponent*> notReady = prewarmedComponents_;
+
+        while(!componentsReadyCancelled_.load(std::memory_order_acquire))
+        {
+            notReady.erase(std::remove_if(notReady.begin(), notReady.end(), [](ISmaccComponent* component)
+            {
+                return component->waitUntilReady(ros::WallDuration(0));
+            }), notReady.end());
+
+            if(notReady.empty() || ros::WallTime::now() >= deadline)
+                break;
+
+            ros::WallDuration(0.01).sleep();
+        }
+
+        if(componentsReadyCancelled_.load(std::memory_order_acquire))
+            return;
+
+        for(ISmaccComponent* component: notReady)
+        {
+            ROS_WARN_STREAM("Component " << component->getName() << " is not ready after " << componentReadyTimeout_ << " seconds");
+        }
+
+        auto waitTime = ros::WallTime::now() - start;
+        componentStartupTime_.store(waitTime.toNSec(), std::memory_order_release);
+        componentsNotReady_.store(notReady.size(), std::memory_order_release);
+        ROS_INFO_STREAM(prewarmedComponents_.size() << " components ready in " << waitTime.toSec()
+                        << " seconds (" << notReady.size() << " not ready)");
+
+        boost::intrusive_ptr<EvComponentsReady> event = new EvComponentsReady();
+        event->notReady = notReady.size();
+        event->waitTime = waitTime;
+        signalDetector_->postEvent(this, event, EventLane::RESULT);
+    });
+}
+
+void ISmaccStateMachine::shutdownComponents()
+{
+    components_.forEach([](ISmaccComponent* component)
+    {
+        component->shutdown();
+    });
+}
+
+void ISmaccStateMachine::stopComponentsReadyWait()
+{
+    componentsReadyCancelled_.store(true, std::memory_order_release);
+    if(componentsReadyThread_.joinable())
+    {
+        componentsReadyThread_.join();
+    }
+}
+
+int64_t ISmaccStateMachine::onEventDispatch(const sc::event_base& evt)
+{
+    auto now = ros::WallTime::now();
+    int64_t latency = -1;
+
+    auto smaccEvent = dynamic_cast<const ISmaccEvent*>(&evt);
+    if(smaccEvent != nullptr)
+    {
+        int64_t creationLatency = (now - smaccEvent->postTime).toNSec();
+        eventLatencyHistogram_.record(creationLatency);
+        SMACC_TRACE("state_machine/event_dispatch", creationLatency);
+
+        // time in the scheduler queue
+        latency = smaccEvent->queueTime.isZero() ? creationLatency : (now - smaccEvent->queueTime).toNSec();
+        smaccEvent->onDispatch();
+    }
+
+    if(eventLog_)
+    {
+        // the custom events do not keep their creation time
+        uint64_t postTime = smaccEvent != nullptr ? smaccEvent->postTime.toNSec() : now.toNSec();
+        eventLog_->append(evt, postTime, now.toNSec());
+    }
+
+    return latency;
+}
+
+void ISmaccStateMachine::onEventProcessed(const sc::event_base& evt, bool transition)
+{
+    if(!transition)
+        return;
+
+    transitionCount_.fetch_add(1, std::memory_order_relaxed);
+
+    auto smaccEvent = dynamic_cast<const ISmaccEvent*>(&evt);
+    if(smaccEvent != nullptr)
+    {
+        reactionLatencyHistogram_.record((ros::WallTime::now() - smaccEvent->postTime).toNSec());
+    }
+}
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/smacc_topic_subscriber.h>
+
+namespace smacc
+{
+void ITopicMessageEvent::onDispatch() const
+{
+    if(subscriber != nullptr)
+    {
+        subscriber->onEventDispatch(this);
+    }
+}
+
+ISmaccTopicSubscriber::ISmaccTopicSubscriber()
+    : latestOnly_(false), lane_(EventLane::FEEDBACK), receivedCount_(0), filteredCount_(0), throttledCount_(0),
+      coalescedCount_(0), postedCount_(0)
+{
+}
+
+ISmaccTopicSubscriber::~ISmaccTopicSubscriber()
+{
+    ISmaccTopicSubscriber::shutdown();
+}
+
+void ISmaccTopicSubscriber::init(ros::NodeHandle& nh)
+{
+    nh_ = nh;
+}
+
+void ISmaccTopicSubscriber::initOffline(ros::NodeHandle& nh)
+{
+    nh_ = nh;
+}
+
+void ISmaccTopicSubscriber::shutdown()
+{
+    ISmaccComponent::shutdown();
+    subscriber_.shutdown();
+}
+
+void ISmaccTopicSubscriber::setMaxRate(double hz)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    minPeriod_ = hz > 0 ? ros::WallDuration(1.0 / hz) : ros::WallDuration();
+}
+
+void ISmaccTopicSubscriber::setLatestOnly(bool latestOnly)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    latestOnly_ = latestOnly;
+}
+
+void ISmaccTopicSubscriber::setEventLane(EventLane lane)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    lane_ = lane;
+}
+
+const std::string& ISmaccTopicSubscriber::getTopic() const
+{
+    return topic_;
+}
+
+unsigned long ISmaccTopicSubscriber::getReceivedCount() const
+{
+    return receivedCount_.load(std::memory_order_relaxed);
+}
+
+unsigned long ISmaccTopicSubscriber::getFilteredCount() const
+{
+    return filteredCount_.load(std::memory_order_relaxed);
+}
+
+unsigned long ISmaccTopicSubscriber::getThrottledCount() const
+{
+    return throttledCount_.load(std::memory_order_relaxed);
+}
+
+unsigned long ISmaccTopicSubscriber::getCoalescedCount() const
+{
+    return coalescedCount_.load(std::memory_order_relaxed);
+}
+
+unsigned long ISmaccTopicSubscriber::getPostedCount() const
+{
+    return postedCount_.load(std::memory_order_relaxed);
+}
+
+bool ISmaccTopicSubscriber::checkRate()
+{
+    if(minPeriod_.isZero())
+        return true;
+
+    auto now = ros::WallTime::now();
+    if(!lastPostTime_.isZero() && now - lastPostTime_ < minPeriod_)
+        return false;
+
+    lastPostTime_ = now;
+    return true;
+}
+}
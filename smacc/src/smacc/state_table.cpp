@@ -0,0 +1,164 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/state_table.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace smacc
+{
+SmaccStateTable::SmaccStateTable()
+{
+}
+
+/**
+******************************************************************************************************************
+* addState()
+******************************************************************************************************************
+*/
+StateId SmaccStateTable::addState(const std::type_info& stateType, const std::string& shortName, StateId parent)
+{
+    StateId id = parents_.size();
+    ids_[std::type_index(stateType)] = id;
+    shortNames_.push_back(shortName);
+    parents_.push_back(parent);
+    depths_.push_back(parent == NO_STATE ? 0 : depths_[parent] + 1);
+    return id;
+}
+
+/**
+******************************************************************************************************************
+* addTransition()
+******************************************************************************************************************
+*/
+void SmaccStateTable::addTransition(StateId source, const std::string& event, StateId target)
+{
+    pendingTransitions_.push_back(std::make_pair(source, Transition{ event, target }));
+}
+
+/**
+******************************************************************************************************************
+* build()
+******************************************************************************************************************
+*/
+void SmaccStateTable::build()
+{
+    int count = size();
+
+    // the parents are always added before their children, so the paths are computed in a single pass
+    fullPaths_.resize(count);
+    for (StateId i = 0; i < count; i++)
+    {
+        if (parents_[i] == NO_STATE)
+            fullPaths_[i] = shortNames_[i];
+        else
+            fullPaths_[i] = fullPaths_[parents_[i]] + "/" + shortNames_[i];
+    }
+
+    // children (counting sort by parent, it keeps the creation order)
+    childOffsets_.assign(count + 2, 0);
+    for (StateId i = 0; i < count; i++)
+    {
+        childOffsets_[parents_[i] + 2]++;
+    }
+
+    for (int i = 1; i < count + 2; i++)
+    {
+        childOffsets_[i] += childOffsets_[i - 1];
+    }
+
+    children_.resize(count);
+    std::vector<int> next(childOffsets_.begin(), childOffsets_.end() - 1);
+    for (StateId i = 0; i < count; i++)
+    {
+        children_[next[parents_[i] + 1]++] = i;
+    }
+
+    // transitions sorted by source and event. Only the last declared transition of each event is kept
+    std::stable_sort(pendingTransitions_.begin(), pendingTransitions_.end(),
+                     [](const std::pair<StateId, Transition>& a, const std::pair<StateId, Transition>& b) {
+                         return a.first < b.first || (a.first == b.first && a.second.event < b.second.event);
+                     });
+
+    transitions_.clear();
+    transitionOffsets_.assign(count + 1, 0);
+    for (std::size_t i = 0; i < pendingTransitions_.size(); i++)
+    {
+        auto& pending = pendingTransitions_[i];
+        bool replaced = i + 1 < pendingTransitions_.size() && pendingTransitions_[i + 1].first == pending.first &&
+                        pendingTransitions_[i + 1].second.event == pending.second.event;
+        if (replaced)
+            continue;
+
+        transitions_.push_back(pending.second);
+        transitionOffsets_[pending.first + 1]++;
+    }
+
+    for (int i = 1; i < count + 1; i++)
+    {
+        transitionOffsets_[i] += transitionOffsets_[i - 1];
+    }
+
+    pendingTransitions_.clear();
+    pendingTransitions_.shrink_to_fit();
+}
+
+/**
+******************************************************************************************************************
+* find()
+******************************************************************************************************************
+*/
+StateId SmaccStateTable::find(const std::type_info& stateType) const
+{
+    auto it = ids_.find(std::type_index(stateType));
+    if (it == ids_.end())
+        return NO_STATE;
+
+    return it->second;
+}
+
+TableRange<StateId> SmaccStateTable::getChildren(StateId state) const
+{
+    const StateId* data = children_.data();
+    return TableRange<StateId>{ data + childOffsets_[state + 1], data + childOffsets_[state + 2] };
+}
+
+TableRange<SmaccStateTable::Transition> SmaccStateTable::getTransitions(StateId state) const
+{
+    const Transition* data = transitions_.data();
+    return TableRange<Transition>{ data + transitionOffsets_[state], data + transitionOffsets_[state + 1] };
+}
+
+/**
+******************************************************************************************************************
+* printAllStates()
+******************************************************************************************************************
+*/
+void SmaccStateTable::printAllStates() const
+{
+    for (StateId state : getChildren(NO_STATE))
+    {
+        std::stringstream ss;
+        ss << "**** Print StateType: " << shortNames_[state] << std::endl;
+        ss << " Childstates:" << std::endl;
+
+        for (StateId child : getChildren(state))
+        {
+            ss << " - " << shortNames_[child] << std::endl;
+        }
+
+        ss << " Transitions:" << std::endl;
+
+        for (auto& transition : getTransitions(state))
+        {
+            ss << " - " << transition.event << " -> " << shortNames_[transition.target] << std::endl;
+        }
+
+        ROS_INFO_STREAM(ss.str());
+    }
+}
+}
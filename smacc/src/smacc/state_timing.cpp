@@ -0,0 +1,198 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/state_timing.h>
+
+namespace smacc
+{
+namespace
+{
+void summary(const LatencyHistogram& histogram, boost::array<uint64_t, 4>& values)
+{
+    values[0] = histogram.mean();
+    values[1] = histogram.percentile(0.5);
+    values[2] = histogram.percentile(0.99);
+    values[3] = histogram.max();
+}
+
+void printCsv(std::ostream& out, const LatencyHistogram& histogram)
+{
+    out << "," << (uint64_t)histogram.mean() << "," << histogram.percentile(0.5) << "," << histogram.percentile(0.99)
+        << "," << histogram.max();
+}
+}
+
+StateTimingTable::StateTimingTable(const SmaccStateTable& stateTable, const std::string& stateMachineName)
+    : stateTable_(stateTable), stateMachineName_(stateMachineName), stats_(new std::atomic<StateTimingStats*>[stateTable.size()])
+{
+    for (int i = 0; i < stateTable.size(); i++)
+    {
+        stats_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+StateTimingTable::~StateTimingTable()
+{
+    for (int i = 0; i < stateTable_.size(); i++)
+    {
+        delete stats_[i].load(std::memory_order_relaxed);
+    }
+}
+
+/**
+******************************************************************************************************************
+* getOrCreate()
+******************************************************************************************************************
+*/
+bool StateTimingTable::isValid(StateId state) const
+{
+    // the states that are only reached through custom reactions are not in the state table (NO_STATE)
+    return state != NO_STATE && state < stateTable_.size();
+}
+
+StateTimingStats& StateTimingTable::getOrCreate(StateId state)
+{
+    StateTimingStats* stats = stats_[state].load(std::memory_order_acquire);
+    if (stats != nullptr)
+        return *stats;
+
+    // other instance of the state machine may be creating it at the same time
+    StateTimingStats* created = new StateTimingStats();
+    if (stats_[state].compare_exchange_strong(stats, created, std::memory_order_acq_rel))
+        return *created;
+
+    delete created;
+    return *stats;
+}
+
+void StateTimingTable::recordEntry(StateId state, uint64_t onEntryNanoseconds)
+{
+    if (!isValid(state))
+        return;
+
+    auto& stats = getOrCreate(state);
+    stats.entries.fetch_add(1, std::memory_order_relaxed);
+    stats.onEntry.record(onEntryNanoseconds);
+}
+
+void StateTimingTable::recordExit(StateId state, uint64_t onExitNanoseconds, uint64_t dwellNanoseconds)
+{
+    if (!isValid(state))
+        return;
+
+    auto& stats = getOrCreate(state);
+    stats.onExit.record(onExitNanoseconds);
+    stats.dwell.record(dwellNanoseconds);
+}
+
+void StateTimingTable::recordEventLatency(StateId state, uint64_t nanoseconds)
+{
+    if (!isValid(state))
+        return;
+
+    getOrCreate(state).eventLatency.record(nanoseconds);
+}
+
+const StateTimingStats* StateTimingTable::find(StateId state) const
+{
+    if (!isValid(state))
+        return nullptr;
+
+    return stats_[state].load(std::memory_order_acquire);
+}
+
+const SmaccStateTable& StateTimingTable::getStateTable() const
+{
+    return stateTable_;
+}
+
+const std::string& StateTimingTable::getStateMachineName() const
+{
+    return stateMachineName_;
+}
+
+/**
+******************************************************************************************************************
+* toMsg()
+******************************************************************************************************************
+*/
+void StateTimingTable::toMsg(smacc::StateTimings& msg) const
+{
+    msg.state_machine = stateMachineName_;
+    msg.states.clear();
+
+    for (StateId state = 0; state < stateTable_.size(); state++)
+    {
+        auto stats = find(state);
+        if (stats == nullptr)
+            continue;
+
+        smacc::StateTiming timing;
+        timing.state = stateTable_.getFullPath(state);
+        timing.entries = stats->entries.load(std::memory_order_relaxed);
+        summary(stats->onEntry, timing.on_entry);
+        summary(stats->onExit, timing.on_exit);
+        summary(stats->dwell, timing.dwell);
+        summary(stats->eventLatency, timing.event_latency);
+        msg.states.push_back(timing);
+    }
+}
+
+/**
+******************************************************************************************************************
+* toString()
+******************************************************************************************************************
+*/
+void StateTimingTable::toString(std::stringstream& ss) const
+{
+    ss << "state timing of " << stateMachineName_ << " (us: mean / p99)" << std::endl;
+    for (StateId state = 0; state < stateTable_.size(); state++)
+    {
+        auto stats = find(state);
+        if (stats == nullptr)
+            continue;
+
+        ss << " - " << stateTable_.getFullPath(state) << ": entries " << stats->entries.load(std::memory_order_relaxed)
+           << ", onEntry " << stats->onEntry.mean() / 1000.0 << " / " << stats->onEntry.percentile(0.99) / 1000.0
+           << ", onExit " << stats->onExit.mean() / 1000.0 << " / " << stats->onExit.percentile(0.99) / 1000.0
+           << ", dwell " << stats->dwell.mean() / 1000.0 << " / " << stats->dwell.percentile(0.99) / 1000.0
+           << ", event latency " << stats->eventLatency.mean() / 1000.0 << " / "
+           << stats->eventLatency.percentile(0.99) / 1000.0 << std::endl;
+    }
+}
+
+/**
+******************************************************************************************************************
+* toCsv()
+******************************************************************************************************************
+*/
+void StateTimingTable::csvHeader(std::ostream& out)
+{
+    out << "state_machine,state,entries";
+    for (auto measure : { "on_entry", "on_exit", "dwell", "event_latency" })
+    {
+        out << "," << measure << "_mean," << measure << "_p50," << measure << "_p99," << measure << "_max";
+    }
+    out << std::endl;
+}
+
+void StateTimingTable::toCsv(std::ostream& out) const
+{
+    for (StateId state = 0; state < stateTable_.size(); state++)
+    {
+        auto stats = find(state);
+        if (stats == nullptr)
+            continue;
+
+        out << stateMachineName_ << "," << stateTable_.getFullPath(state) << ","
+            << stats->entries.load(std::memory_order_relaxed);
+        printCsv(out, stats->onEntry);
+        printCsv(out, stats->onExit);
+        printCsv(out, stats->dwell);
+        printCsv(out, stats->eventLatency);
+        out << std::endl;
+    }
+}
+}
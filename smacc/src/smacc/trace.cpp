@@ -0,0 +1,262 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/trace.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace smacc
+{
+namespace trace
+{
+namespace
+{
+// ring buffer of one thread. Only its thread writes it
+struct ThreadBuffer
+{
+    ThreadBuffer(uint32_t threadIndex, std::size_t size)
+        : thread(threadIndex), osThreadId(syscall(SYS_gettid)), records(size), mask(size - 1), writeIndex(0)
+    {
+    }
+
+    uint32_t thread;
+    uint32_t osThreadId;
+    std::vector<Record> records;
+    uint64_t mask;
+    std::atomic<uint64_t> writeIndex;
+};
+
+void dumpAtExit();
+
+struct TraceRegistry
+{
+    TraceRegistry()
+        : bufferSize(16384)
+    {
+        configure();
+    }
+
+    // reads the private parameters of the node that traces first (the smacc node or any other process
+    // that only links smacc_trace, like move_base with the smacc local planners)
+    void configure()
+    {
+        std::string nodeName = ros::isInitialized() ? ros::this_node::getName() : "/" + std::to_string(getpid());
+        std::replace(nodeName.begin(), nodeName.end(), '/', '_');
+        file = "/tmp/smacc_trace" + nodeName + ".bin";
+
+        if (ros::isInitialized())
+        {
+            int records;
+            if (ros::param::get("~smacc_trace_buffer_size", records) && records > 0)
+                setBufferSize(records);
+
+            ros::param::get("~smacc_trace_file", file);
+        }
+
+        // an empty file name disables the dump
+        if (!file.empty())
+            std::atexit(dumpAtExit);
+    }
+
+    void setBufferSize(std::size_t records)
+    {
+        bufferSize = 2;
+        while (bufferSize < records)
+            bufferSize <<= 1;
+    }
+
+    std::mutex mutex;
+
+    // event names and argument formats (index = id - 1)
+    std::vector<std::pair<std::string, std::string>> events;
+    std::map<std::pair<std::string, std::string>, uint32_t> eventIds;
+
+    // the buffers are never released, so that the records of finished threads can still be dumped
+    std::vector<ThreadBuffer*> buffers;
+    std::size_t bufferSize;
+
+    // written on process exit
+    std::string file;
+};
+
+// it is never destroyed: other threads may still be tracing during the static destruction
+TraceRegistry& registry()
+{
+    static TraceRegistry* instance = new TraceRegistry();
+    return *instance;
+}
+
+thread_local ThreadBuffer* currentBuffer = nullptr;
+
+ThreadBuffer* createThreadBuffer()
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto buffer = new ThreadBuffer(reg.buffers.size(), reg.bufferSize);
+    reg.buffers.push_back(buffer);
+    return buffer;
+}
+
+uint64_t steadyNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void dumpAtExit()
+{
+    const std::string& file = registry().file;
+    if (dump(file))
+        ROS_INFO_STREAM("[smacc trace] trace written to " << file << " (decode it with smacc_trace_dump)");
+    else
+        ROS_ERROR_STREAM("[smacc trace] the trace could not be written to " << file);
+}
+}
+
+/**
+******************************************************************************************************************
+* registerEvent()
+******************************************************************************************************************
+*/
+uint32_t registerEvent(EventId& event, const std::string& name, const std::string& format)
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    // other thread may have registered it meanwhile
+    uint32_t id = event.id.load(std::memory_order_acquire);
+    if (id != 0)
+        return id;
+
+    auto key = std::make_pair(name, format);
+    auto it = reg.eventIds.find(key);
+    if (it != reg.eventIds.end())
+    {
+        id = it->second;
+    }
+    else
+    {
+        reg.events.push_back(key);
+        id = reg.events.size();
+        reg.eventIds[key] = id;
+    }
+
+    event.id.store(id, std::memory_order_release);
+    return id;
+}
+
+/**
+******************************************************************************************************************
+* write()
+******************************************************************************************************************
+*/
+void write(uint32_t event, const uint64_t* args, int argCount)
+{
+    ThreadBuffer* buffer = currentBuffer;
+    if (buffer == nullptr)
+    {
+        buffer = currentBuffer = createThreadBuffer();
+    }
+
+    uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+    Record& record = buffer->records[index & buffer->mask];
+    record.timestamp = steadyNow();
+    record.thread = buffer->thread;
+    record.event = event;
+    for (int i = 0; i < MAX_ARGS; i++)
+    {
+        record.args[i] = i < argCount ? args[i] : 0;
+    }
+
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void setBufferSize(std::size_t records)
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.setBufferSize(records);
+}
+
+/**
+******************************************************************************************************************
+* dump()
+******************************************************************************************************************
+*/
+bool dump(const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.eventCount = reg.events.size();
+    header.threadCount = reg.buffers.size();
+    header.reserved = 0;
+    header.steadyReference = steadyNow();
+    header.systemReference =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    file.write((const char*)&header, sizeof(header));
+
+    for (std::size_t i = 0; i < reg.events.size(); i++)
+    {
+        auto& event = reg.events[i];
+        EventHeader eventHeader;
+        eventHeader.id = i + 1;
+        eventHeader.nameLength = event.first.size();
+        eventHeader.formatLength = event.second.size();
+        file.write((const char*)&eventHeader, sizeof(eventHeader));
+        file.write(event.first.data(), event.first.size());
+        file.write(event.second.data(), event.second.size());
+    }
+
+    std::vector<Record> records;
+    for (auto* buffer : reg.buffers)
+    {
+        uint64_t capacity = buffer->records.size();
+
+        // the owner thread may still be writing: copy the records and discard the ones that
+        // were overwritten during the copy
+        uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > capacity ? end - capacity : 0;
+
+        records.clear();
+        for (uint64_t index = begin; index < end; index++)
+        {
+            records.push_back(buffer->records[index & buffer->mask]);
+        }
+
+        uint64_t endAfterCopy = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t overwritten = endAfterCopy > capacity ? endAfterCopy - capacity : 0;
+        std::size_t skip = overwritten > begin ? std::min<uint64_t>(overwritten - begin, records.size()) : 0;
+
+        ThreadHeader threadHeader;
+        threadHeader.thread = buffer->thread;
+        threadHeader.osThreadId = buffer->osThreadId;
+        threadHeader.recordCount = records.size() - skip;
+        threadHeader.lostCount = begin + skip;
+        file.write((const char*)&threadHeader, sizeof(threadHeader));
+        file.write((const char*)(records.data() + skip), threadHeader.recordCount * sizeof(Record));
+    }
+
+    return (bool)file;
+}
+}
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+#include <smacc/type_name.h>
+
+#include <cstring>
+
+namespace smacc
+{
+namespace detail
+{
+/**
+******************************************************************************************************************
+* typeNameFromSignature()
+******************************************************************************************************************
+*/
+std::string typeNameFromSignature(const char* signature)
+{
+    // gcc: "... [with T = ns::State]", clang: "... [T = ns::State]"
+    const char* begin = std::strstr(signature, "T = ");
+    if (begin == nullptr)
+        return signature;
+
+    begin += 4;
+
+    // the name ends at the closing bracket of the signature (or at the next template parameter)
+    int depth = 0;
+    const char* end = begin;
+    for (; *end != '\0'; end++)
+    {
+        char c = *end;
+        if (c == '<' || c == '(' || c == '[')
+        {
+            depth++;
+        }
+        else if (c == '>' || c == ')' || c == ']')
+        {
+            if (depth == 0)
+                break;
+
+            depth--;
+        }
+        else if (c == ';' && depth == 0)
+        {
+            break;
+        }
+    }
+
+    return std::string(begin, end);
+}
+
+/**
+******************************************************************************************************************
+* shortTypeName()
+******************************************************************************************************************
+*/
+std::string shortTypeName(const std::string& typeName)
+{
+    // last "::" outside the template arguments
+    int depth = 0;
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < typeName.size(); i++)
+    {
+        char c = typeName[i];
+        if (c == '<' || c == '(')
+            depth++;
+        else if (c == '>' || c == ')')
+            depth--;
+        else if (c == ':' && depth == 0 && i + 1 < typeName.size() && typeName[i + 1] == ':')
+            begin = i + 2;
+    }
+
+    return typeName.substr(begin);
+}
+
+/**
+******************************************************************************************************************
+* rosName()
+******************************************************************************************************************
+*/
+std::string rosName(const std::string& typeName)
+{
+    std::string name;
+    name.reserve(typeName.size());
+    for (char c : typeName)
+    {
+        bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        if (valid)
+            name += c;
+        else if (!name.empty() && name.back() != '_')
+            name += '_';
+    }
+
+    while (!name.empty() && name.back() == '_')
+        name.pop_back();
+
+    return name;
+}
+}
+}
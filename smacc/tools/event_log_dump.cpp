@@ -0,0 +1,63 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Prints the event logs recorded by the state machines (parameter ~smacc_event_log_file)
+//
+// usage: smacc_event_log_dump <event log> [--summary]
+//  - by default it prints one line per event: dispatch time (s from the first event), latency (us),
+//    payload size and event type
+//  - --summary prints the number of events of each type
+#include <smacc/event_log.h>
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <event log> [--summary]" << std::endl;
+        return 1;
+    }
+
+    bool summary = argc > 2 && std::string(argv[2]) == "--summary";
+
+    smacc::EventLogReader reader;
+    if (!reader.open(argv[1]))
+    {
+        std::cerr << argv[1] << " is not a smacc event log" << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, uint64_t> counts;
+    uint64_t first = 0;
+
+    smacc::EventLogReader::Event event;
+    while (reader.next(event))
+    {
+        std::string type = event.type != nullptr ? *event.type : "(unknown type)";
+        if (summary)
+        {
+            counts[type]++;
+            continue;
+        }
+
+        if (first == 0)
+            first = event.header.dispatchTime;
+
+        std::printf("%14.6f %10.1f %6zu %s%s\n", (event.header.dispatchTime - first) / 1e9,
+                    ((int64_t)event.header.dispatchTime - (int64_t)event.header.postTime) / 1e3, event.size,
+                    type.c_str(), event.header.noCodec ? " (no codec)" : "");
+    }
+
+    for (auto& entry : counts)
+    {
+        std::printf("%10llu %s\n", (unsigned long long)entry.second, entry.first.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*****************************************************************************************************************
+ * ReelRobotix Inc. - Software License Agreement      Copyright (c) 2018
+ * 	 Authors: Pablo Inigo Blasco, Brett Aldrich
+ *
+ ******************************************************************************************************************/
+// Decodes the binary trace files written by smacc::trace::dump()
+//
+// usage: smacc_trace_dump <trace file> [--summary]
+//  - by default it prints all the records sorted by time
+//  - --summary prints the number of records of each event
+#include <smacc/trace.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace smacc::trace;
+
+struct EventInfo
+{
+    std::string name;
+    std::string format;
+};
+
+template <typename T>
+bool readStruct(std::ifstream& file, T& value)
+{
+    return (bool)file.read((char*)&value, sizeof(T));
+}
+
+std::string readString(std::ifstream& file, std::size_t length)
+{
+    std::string ret(length, '\0');
+    file.read(&ret[0], length);
+    return ret;
+}
+
+void printArg(char code, uint64_t value)
+{
+    switch (code)
+    {
+    case 'd':
+    {
+        double d;
+        std::memcpy(&d, &value, sizeof(d));
+        std::printf(" %g", d);
+        break;
+    }
+    case 'i':
+        std::printf(" %lld", (long long)(int64_t)value);
+        break;
+    case 'p':
+        std::printf(" 0x%llx", (unsigned long long)value);
+        break;
+    default:
+        std::printf(" %llu", (unsigned long long)value);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace file> [--summary]" << std::endl;
+        return 1;
+    }
+
+    bool summary = argc > 2 && std::string(argv[2]) == "--summary";
+
+    std::ifstream file(argv[1], std::ios::binary);
+    FileHeader header;
+    if (!file || !readStruct(file, header) || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+    {
+        std::cerr << argv[1] << " is not a smacc trace file" << std::endl;
+        return 1;
+    }
+
+    if (header.version != FILE_VERSION)
+    {
+        std::cerr << "unsupported trace file version: " << header.version << std::endl;
+        return 1;
+    }
+
+    std::map<uint32_t, EventInfo> events;
+    for (uint32_t i = 0; i < header.eventCount; i++)
+    {
+        EventHeader eventHeader;
+        readStruct(file, eventHeader);
+        EventInfo& info = events[eventHeader.id];
+        info.name = readString(file, eventHeader.nameLength);
+        info.format = readString(file, eventHeader.formatLength);
+    }
+
+    std::vector<Record> records;
+    std::map<uint32_t, uint32_t> osThreadIds;
+    for (uint32_t i = 0; i < header.threadCount; i++)
+    {
+        ThreadHeader threadHeader;
+        readStruct(file, threadHeader);
+        osThreadIds[threadHeader.thread] = threadHeader.osThreadId;
+
+        std::size_t offset = records.size();
+        records.resize(offset + threadHeader.recordCount);
+        file.read((char*)(records.data() + offset), threadHeader.recordCount * sizeof(Record));
+
+        std::cerr << "thread " << threadHeader.thread << " (tid " << threadHeader.osThreadId
+                  << "): " << threadHeader.recordCount << " records, " << threadHeader.lostCount << " lost" << std::endl;
+    }
+
+    if (!file)
+    {
+        std::cerr << "truncated trace file" << std::endl;
+        return 1;
+    }
+
+    if (summary)
+    {
+        std::map<uint32_t, uint64_t> counts;
+        for (auto& record : records)
+            counts[record.event]++;
+
+        for (auto& count : counts)
+            std::printf("%12llu %s\n", (unsigned long long)count.second, events[count.first].name.c_str());
+
+        return 0;
+    }
+
+    std::sort(records.begin(), records.end(),
+              [](const Record& a, const Record& b) { return a.timestamp < b.timestamp; });
+
+    for (auto& record : records)
+    {
+        // wall time of the record
+        int64_t wall = (int64_t)header.systemReference - (int64_t)(header.steadyReference - record.timestamp);
+        const EventInfo& info = events[record.event];
+
+        std::printf("%lld.%09lld [%u] %s", (long long)(wall / 1000000000), (long long)(wall % 1000000000),
+                    osThreadIds[record.thread], info.name.c_str());
+
+        for (std::size_t i = 0; i < info.format.size() && i < (std::size_t)MAX_ARGS; i++)
+        {
+            printArg(info.format[i], record.args[i]);
+        }
+
+        std::printf("\n");
+    }
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <pluginlib/class_list_macros.h>
 #include <backward_local_planner/backward_local_planner.h>
 #include <visualization_msgs/MarkerArray.h>
+#include <smacc/trace.h>
 
 //register this planner as a BaseLocalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(backward_local_planner::BackwardLocalPlanner, nav_core::BaseLocalPlanner)
@@ -100,7 +101,8 @@ bool BackwardLocalPlanner::createCarrotGoal(const tf::Stamped<tf::Pose>& tfpose)
             double pangle = tf::getYaw(q);
             double angular_error = angles::shortest_angular_distance(pangle, angle);
 
-            ROS_WARN("pure spinning stage, angle: %lf threshold: %lf", angular_error, carrot_angular_distance_);
+            ROS_DEBUG("pure spinning stage, angle: %lf threshold: %lf", angular_error, carrot_angular_distance_);
+            SMACC_TRACE("backward_local_planner/pure_spinning_stage", angular_error, carrot_angular_distance_);
 
             if(fabs(angular_error) >= carrot_angular_distance_)
             {
@@ -144,8 +146,8 @@ bool BackwardLocalPlanner::createCarrotGoal(const tf::Stamped<tf::Pose>& tfpose)
             if (dist >= carrot_distance_ ) 
             {
                 ok = true;
-                ROS_INFO("target dist: %lf / %lf", dist, carrot_distance_);
-                ROS_INFO("Retracting: %lf/100", 100.0 * currentPoseIndex_ / (double)backwardsPlanPath_.size());
+                ROS_DEBUG("target dist: %lf / %lf", dist, carrot_distance_);
+                ROS_DEBUG("Retracting: %lf/100", 100.0 * currentPoseIndex_ / (double)backwardsPlanPath_.size());
                 currentPoseIndex_--;
             }
         }
@@ -157,7 +159,8 @@ bool BackwardLocalPlanner::createCarrotGoal(const tf::Stamped<tf::Pose>& tfpose)
         ok = true;
     }
     
-    ROS_INFO("current index: %d", currentPoseIndex_);
+    ROS_DEBUG("current index: %d", currentPoseIndex_);
+    SMACC_TRACE("backward_local_planner/carrot", currentPoseIndex_, backwardsPlanPath_.size(), pureSpinning);
     
     return pureSpinning;
 }
@@ -228,7 +231,7 @@ bool BackwardLocalPlanner::computeVelocityCommands(geometry_msgs::Twist& cmd_vel
     bool initialPureSpinningDefaultMovement = createCarrotGoal(tfpose);
 
     const geometry_msgs::PoseStamped& goalpose = backwardsPlanPath_[currentPoseIndex_];
-    ROS_INFO_STREAM("goal pose current index: " << goalpose);
+    ROS_DEBUG_STREAM("goal pose current index: " << goalpose);
     const geometry_msgs::Point& goalposition = goalpose.pose.position;
 
     tf::Quaternion goalQ;
@@ -261,7 +264,7 @@ bool BackwardLocalPlanner::computeVelocityCommands(geometry_msgs::Twist& cmd_vel
     }
     else
     {
-        ROS_WARN("pure spinning: %d", initialPureSpinningDefaultMovement);
+        ROS_DEBUG("pure spinning: %d", initialPureSpinningDefaultMovement);
         if(initialPureSpinningDefaultMovement)
         {
             vetta = 0;
@@ -272,7 +275,9 @@ bool BackwardLocalPlanner::computeVelocityCommands(geometry_msgs::Twist& cmd_vel
 
     publishGoalMarker(goalposition.x, goalposition.y, betta);
 
-    ROS_INFO_STREAM("local planner," << std::endl
+    SMACC_TRACE("backward_local_planner/cmd_vel", rho_error, alpha_error, betta_error, vetta, gamma);
+
+    ROS_DEBUG_STREAM("local planner," << std::endl
                                       << " theta: " << theta << std::endl
                                       << " betta: " << theta << std::endl
                                       << " err_x: " << dx << std::endl
@@ -7,6 +7,7 @@
 #include <pluginlib/class_list_macros.h>
 #include <forward_local_planner/forward_local_planner.h>
 #include <visualization_msgs/MarkerArray.h>
+#include <smacc/trace.h>
 
 //register this planner as a BaseLocalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(forward_local_planner::ForwardLocalPlanner, nav_core::BaseLocalPlanner)
@@ -204,6 +205,7 @@ bool ForwardLocalPlanner::computeVelocityCommands(geometry_msgs::Twist& cmd_vel)
     cmd_vel.angular.z = gamma;
 
     //ROS_INFO_STREAM("Local planner: "<< cmd_vel);
+    SMACC_TRACE("forward_local_planner/cmd_vel", rho_error, alpha_error, betta_error, vetta, gamma, currentPoseIndex_);
 
     publishGoalMarker(goalposition.x, goalposition.y, betta);
     
@@ -37,6 +37,9 @@ class OdomTracker: public smacc::ISmaccComponent
         // current path
         virtual void init(ros::NodeHandle& nh) override;
 
+        // offline mode (event replay): no odometry subscription and no path publication
+        virtual void initOffline(ros::NodeHandle& nh) override;
+
         // threadsafe
         /// odom callback: Updates the path - this must be called periodically for each odometry message. 
         // The odom parameters is the main input of this tracker
@@ -36,12 +36,29 @@ void OdomTracker::init(ros::NodeHandle& nh)
 
     if(this->subscribeToOdometryTopic_)
     {
-        odomSub_= nh.subscribe("odom", 1, &OdomTracker::processOdometryMessage, this);
+        // with the global callback queue the messages are dispatched at the signal detector rate and the ones
+        // received between two spins are dropped. A dedicated callback queue (~smacc_component_callback_threads)
+        // processes them at the odometry rate
+        int odomQueueSize;
+        nh.param("odom_queue_size", odomQueueSize, 1);
+        odomSub_= nh.subscribe("odom", odomQueueSize, &OdomTracker::processOdometryMessage, this);
     }
 
     robotBasePathPub_ = std::make_shared<realtime_tools::RealtimePublisher<nav_msgs::Path>>(nh, "odom_tracker_path", 1);
 }
 
+/**
+******************************************************************************************************************
+* initOffline()
+******************************************************************************************************************
+*/
+void OdomTracker::initOffline(ros::NodeHandle& nh)
+{
+    minPointDistanceForwardThresh_ = 0.005;
+    minPointDistanceBackwardThresh_ = 0.05;
+    publishMessages = false;
+}
+
 
 /**
 ******************************************************************************************************************
@@ -126,7 +143,8 @@ nav_msgs::Path OdomTracker::getPath()
 */
 void OdomTracker::rtPublishPaths(ros::Time timestamp)
 {
-    if(robotBasePathPub_->trylock())
+    // there is no publisher in offline mode
+    if(robotBasePathPub_ && robotBasePathPub_->trylock())
     {
         nav_msgs::Path& msg = robotBasePathPub_->msg_;
         ///  Copy trajectory
@@ -39,6 +39,10 @@ void PlannerSwitcher::updatePlanners(bool subscribecallback)
   ROS_INFO_STREAM("Setting global planner: " << desired_global_planner_);
   ROS_INFO_STREAM("Setting local planner: " << desired_local_planner_);
 
+  // offline mode (event replay): there is no move_base to configure
+  if(smacc::isOfflineMode())
+    return;
+
   dynamic_reconfigure::ReconfigureRequest srv_req;
   dynamic_reconfigure::ReconfigureResponse srv_resp;
   dynamic_reconfigure::StrParameter local_planner, global_planner;